@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/uio.h>
+#include "ConverterJSON.h"
+#include "ThreadPool.h"
+
+//Потоковая запись ответов без построения DOM.
+//Формат Pretty совпадает байт в байт с прежним nlohmann::json::dump(4)
+//(ключи внутри ответа в алфавитном порядке, числа в записи nlohmann),
+//Compact — то же, что dump() без отступов.
+//Cbor и MessagePack — та же схема в двоичном виде: doc_id — целое минимальной
+//длины (до 32 бит на практике), rank — float32. Словарь ответов в CBOR
+//неопределенной длины, в MessagePack — map32, число ответов дописывается в Finish.
+//
+//С одним потоком ответ форматируется сразу в общий буфер. С несколькими потоками
+//ответы копятся до kParallelRound штук, затем пул форматирует их кусками по kChunkSize
+//в собственные буферы кусков (переиспользуются между раундами), и буферы уходят
+//в файл по порядку одним writev.
+class AnswersWriter {
+public:
+    enum class Format { Pretty, Compact, Cbor, MessagePack };
+
+    static constexpr size_t kChunkSize = 1024;
+
+    //threads = 0 — по числу ядер. Бросает runtime_error, если файл не удается создать
+    AnswersWriter(const std::string& path, Format format, size_t maxResponses, size_t threads = 1);
+    //Незавершенный файл дописывается до корректного JSON
+    ~AnswersWriter();
+
+    AnswersWriter(AnswersWriter&& other) noexcept;
+    AnswersWriter& operator=(AnswersWriter&&) = delete;
+    AnswersWriter(const AnswersWriter&) = delete;
+    AnswersWriter& operator=(const AnswersWriter&) = delete;
+
+    //Ответ на очередной запрос; номера запросов идут по порядку с 1
+    void Add(const std::vector<RelativeIndex>& results);
+    void Add(std::vector<RelativeIndex>&& results);
+    //Ответы на следующие answers.size() запросов без копирования
+    void AddAll(const std::vector<std::vector<RelativeIndex>>& answers);
+    //Закрывающие скобки и сброс буфера; бросает runtime_error при ошибке записи
+    void Finish();
+
+    size_t Count() const { return count; }
+
+    //Запись ответа на запрос с номером index (с 0) вместе с разделителем перед ним
+    static void AppendAnswer(std::string& out, size_t index, const std::vector<RelativeIndex>& results,
+                             size_t maxResponses, Format format);
+    //"request001", ..., "request999", "request1000", ...
+    static void AppendRequestId(std::string& out, size_t index);
+
+    //Чтение файла ответов в любом из форматов (через nlohmann::json) — для проверок
+    //и потребителей на C++. Бросает runtime_error, если файл не читается или не разбирается
+    static std::vector<std::vector<RelativeIndex>> Read(const std::string& path, Format format);
+
+private:
+    //Ответов в одном параллельном раунде
+    size_t parallelRound() const { return kChunkSize * pool->Size() * 4; }
+    //Параллельное форматирование answers[begin, end) и запись вместе с buffer
+    void writeParallel(const std::vector<std::vector<RelativeIndex>>& answers, size_t begin, size_t end);
+    void flushPending();
+    void flush();
+    //Запись частей по порядку; частичные записи дописываются
+    void writeAll(std::vector<iovec>& parts);
+
+    int fd = -1;
+    std::string path;
+    std::string buffer;
+    Format format;
+    size_t maxResponses;
+    size_t count = 0;
+    bool finished = false;
+
+    std::unique_ptr<ThreadPool> pool; //нет при одном потоке
+    std::vector<std::vector<RelativeIndex>> pending;
+    std::vector<std::string> chunkBuffers;
+};
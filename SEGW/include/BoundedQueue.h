@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+
+//Ограниченная очередь без блокировок для нескольких производителей и потребителей
+//(кольцевой буфер с порядковым номером в каждой ячейке).
+//Полная очередь останавливает производителя (backpressure), пустая — потребителя;
+//ожидание — короткое вращение, затем уступка процессора и сон.
+//После Close новые элементы не принимаются, а Pop возвращает false, когда очередь опустеет.
+template <typename T>
+class BoundedQueue {
+public:
+    //capacity округляется вверх до степени двойки
+    explicit BoundedQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        mask = size - 1;
+        cells = std::make_unique<Cell[]>(size);
+        for (size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    bool TryPush(T& value) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; //очередь заполнена
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool TryPop(T& value) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; //очередь пуста
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    //Ждет свободного места; false, если очередь закрыта
+    bool Push(T value) {
+        for (unsigned attempt = 0;; ++attempt) {
+            if (closed.load(std::memory_order_acquire)) {
+                return false;
+            }
+            if (TryPush(value)) {
+                return true;
+            }
+            backoff(attempt);
+        }
+    }
+
+    //Ждет элемента; false, если очередь закрыта и пуста
+    bool Pop(T& value) {
+        for (unsigned attempt = 0;; ++attempt) {
+            if (TryPop(value)) {
+                return true;
+            }
+            if (closed.load(std::memory_order_acquire)) {
+                return TryPop(value);
+            }
+            backoff(attempt);
+        }
+    }
+
+    void Close() { closed.store(true, std::memory_order_release); }
+    bool IsClosed() const { return closed.load(std::memory_order_acquire); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    static void backoff(unsigned attempt) {
+        if (attempt < 64) {
+            return;
+        }
+        if (attempt < 256) {
+            std::this_thread::yield();
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    //Голова и хвост в разных строках кэша, чтобы производители и потребители не мешали друг другу
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) std::atomic<bool> closed{false};
+    size_t mask = 0;
+    std::unique_ptr<Cell[]> cells;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Postings.h"
+
+// Курсор по списку вхождений, выдающий его поблочно.
+// Несжатый список выдается одним блоком без копирования,
+// сжатый декодируется по kBlockSize вхождений во внутренний буфер.
+// Оборванный или поврежденный сжатый список — std::runtime_error из конструктора или Next.
+class PostingCursor {
+public:
+    static constexpr size_t kBlockSize = 128;
+
+    PostingCursor() = default;
+    explicit PostingCursor(PostingsView raw) : raw_(raw), rawPending_(!raw.empty()) {}
+    PostingCursor(const uint8_t* data, const uint8_t* end);
+
+    // Переход к следующему блоку; false, если список исчерпан
+    bool Next();
+    PostingsView Block() const { return block_; }
+
+private:
+    PostingsView raw_;
+    bool rawPending_ = false;
+
+    const uint8_t* data_ = nullptr;
+    const uint8_t* end_ = nullptr;
+    size_t remaining_ = 0;
+    size_t lastDocId_ = 0;
+
+    PostingsView block_;
+    Entry buffer_[kBlockSize];
+};
+
+// Потоковое кодирование одного списка в формате CompressedPostings.
+// Число вхождений задается в Begin (оно пишется первым), вхождения подаются
+// порциями любого размера по возрастанию doc_id; в памяти держится не больше одного блока.
+// Байты дописываются в конец out, после каждого вызова их можно сбросить.
+class PostingEncoder {
+public:
+    void Begin(size_t count, std::vector<uint8_t>& out);
+    void Add(PostingsView entries, std::vector<uint8_t>& out);
+    // Подано меньше или больше вхождений, чем объявлено в Begin, — std::logic_error
+    void End(std::vector<uint8_t>& out);
+
+private:
+    void flushBlock(std::vector<uint8_t>& out);
+
+    size_t remaining_ = 0;
+    size_t lastDocId_ = 0;
+    size_t pending_ = 0;
+    Entry block_[PostingCursor::kBlockSize];
+};
+
+// Сжатое хранилище списков вхождений.
+// Все списки лежат в одном массиве байт; каждый список — это varint с числом
+// вхождений, затем блоки по kBlockSize: разности doc_id, затем значения count - 1,
+// все в формате varint (7 бит на байт).
+class CompressedPostings {
+public:
+    // Добавляет список (doc_id по возрастанию); номер списка — порядковый
+    void Append(const std::vector<Entry>& entries);
+    void Clear();
+
+    // Кодирование одного списка в конец out (формат описан выше)
+    static void Encode(const std::vector<Entry>& entries, std::vector<uint8_t>& out);
+    // Число вхождений в закодированном списке [data, end)
+    static size_t EncodedCount(const uint8_t* data, const uint8_t* end);
+
+    size_t ListCount() const { return offsets_.size() - 1; }
+    size_t PostingCount(size_t list) const;
+    size_t ByteSize() const { return bytes_.size() + offsets_.size() * sizeof(uint64_t); }
+
+    const uint8_t* ListData(size_t list) const { return bytes_.data() + offsets_[list]; }
+    size_t ListSize(size_t list) const { return offsets_[list + 1] - offsets_[list]; }
+
+    PostingCursor Cursor(size_t list) const {
+        return PostingCursor(bytes_.data() + offsets_[list], bytes_.data() + offsets_[list + 1]);
+    }
+
+private:
+    std::vector<uint8_t> bytes_;
+    std::vector<uint64_t> offsets_{0};
+};
@@ -2,6 +2,7 @@
 #include <vector>
 #include <string>
 #include <nlohmann/json.hpp>
+#include "RequestSource.h"
 
 //Структура для хранения относительного индекса релевантности
 struct RelativeIndex {
@@ -24,6 +25,8 @@ struct RelativeIndex {
     }
 };
 
+class AnswersWriter;
+
 //Класс для работы с JSON-файлами конфигурации, запросов и ответов
 class ConverterJSON {
 private:
@@ -34,8 +37,35 @@ private:
     bool auto_discover_files;
     size_t max_files_to_process;
     std::string resources_directory;
+    std::vector<std::string> supported_extensions;
+    size_t max_file_size_mb;
+    size_t thread_pool_size;
+    bool compress_postings;
+    std::string index_segment;
+    size_t index_memory_budget_mb;
+    size_t loader_threads;
+    std::string io_backend;
+    std::string requests_file;
+    bool compact_answers;
+    std::string answers_format;
+    // Корень проекта и каталоги поиска файлов определяются один раз при загрузке
+    std::string projectRoot;
+    std::vector<std::string> searchPrefixes;
+    // Абсолютные пути документов в порядке doc_id; пустая строка — файл не найден
+    std::vector<std::string> resolvedPaths;
+    double pathResolutionMs;
 
+    void initSearchPrefixes();
+    // Поиск файла по каталогам searchPrefixes; prefixHint — каталог, проверяемый первым
+    // (обновляется при успехе: соседние документы обычно лежат в одном каталоге)
+    bool locateFile(const std::string& filename, size_t& prefixHint, std::string& resolved) const;
     std::string findFile(const std::string& filename) const;
+    void resolveDocumentPaths();
+    // Чтение файла целиком; переводы строк заменяются пробелами, как при построчном чтении
+    static bool readWholeFile(const std::string& path, std::string& content);
+    // Замена переводов строк пробелами в прочитанном целиком файле
+    static void normalizeLineBreaks(std::string& content);
+    void logLoaded(size_t index, const std::string& content) const;
     void loadConfig();
     void discoverFiles();
 
@@ -44,9 +74,41 @@ public:
     ~ConverterJSON();
     
     std::vector<std::string> GetTextDocuments() const;
+    // Чтение одного документа; недоступный файл дает пустой документ.
+    // Потокобезопасно: может вызываться одновременно из нескольких потоков
+    std::string ReadDocument(size_t index) const;
+    // Чтение документов [begin, end) в texts[0 .. end - begin).
+    // При io_backend = "io_uring" файлы пакета читаются через одно кольцо io_uring
+    // (свое в каждом потоке), иначе — по одному, как ReadDocument
+    void ReadDocuments(size_t begin, size_t end, std::vector<std::string>& texts) const;
+    // Пути к документам в порядке doc_id
+    const std::vector<std::string>& GetFilePaths() const;
+    // Абсолютные пути документов, найденные при загрузке конфигурации
+    const std::vector<std::string>& GetResolvedPaths() const;
+    // Время поиска путей документов при загрузке конфигурации, мс
+    double GetPathResolutionMs() const;
     std::vector<std::string> GetRequests() const;
+    // Источник запросов из requests_file (для .jsonl — потоковое чтение);
+    // бросает runtime_error, если файл не найден
+    RequestSource OpenRequests() const;
     void putAnswers(const std::vector<std::vector<RelativeIndex>>& answers) const;
+    // Потоковая запись ответов в GetAnswersPath(): ответы добавляются по мере готовности
+    // и форматируются в thread_pool_size потоков (нужен AnswersWriter.h);
+    // бросает runtime_error, если файл не создается
+    AnswersWriter OpenAnswers() const;
+    // JSON/answers.json, JSON/answers.cbor или JSON/answers.msgpack по answers_format
+    std::string GetAnswersPath() const;
     size_t GetResponsesLimit() const;
+    size_t GetThreadPoolSize() const;
+    bool GetCompressPostings() const;
+    std::string GetIndexSegmentPath() const;
+    // Бюджет памяти построения индекса в МБ; 0 — индекс строится целиком в памяти
+    size_t GetIndexMemoryBudgetMb() const;
+    // Число потоков чтения документов (0 — по числу ядер)
+    size_t GetLoaderThreads() const;
+    // Способ чтения документов: "threads" или "io_uring"
+    // (если io_uring недоступен, при загрузке конфигурации выбирается "threads")
+    std::string GetIoBackend() const;
     std::string GetAppName() const;
     std::string GetVersion() const;
 };
\ No newline at end of file
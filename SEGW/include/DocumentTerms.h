@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Tokenizer.h"
+
+// Слова одного документа с числом вхождений — результат стадии токенизации,
+// независимый от словаря индекса. Байты всех слов лежат в одном буфере.
+struct DocumentTerms {
+    struct Term {
+        uint32_t offset;
+        uint32_t length;
+        uint32_t count;
+    };
+
+    uint64_t length = 0;     // длина текста в байтах
+    uint64_t tokenCount = 0; // число слов после нормализации
+    std::string bytes;
+    std::vector<Term> terms; // по возрастанию слов
+
+    // Токенизация text; слова длиннее Tokenizer::kMaxWordLength не учитываются
+    void Assign(std::string_view text, Tokenizer& tokenizer);
+
+    std::string_view Word(const Term& term) const {
+        return std::string_view(bytes.data() + term.offset, term.length);
+    }
+};
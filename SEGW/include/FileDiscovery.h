@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Рекурсивный параллельный обход каталога с документами.
+// Потоки обхода разбирают каталоги из общего стека: каждый читает каталог
+// целиком (readdir, тип записи из d_type без лишних stat), подкаталоги кладет
+// обратно в стек, подходящие файлы передает в обработчик пакетом.
+// stat выполняется только для файлов с подходящим расширением и только
+// если задан предел размера.
+class FileDiscovery {
+public:
+    struct Options {
+        // Допустимые расширения (с точкой, с учетом регистра); пустой список — любые
+        std::vector<std::string> extensions;
+        // Предел размера файла в байтах; 0 — без ограничения
+        uint64_t maxFileSize = 0;
+        // 0 — по числу ядер
+        size_t threads = 0;
+    };
+
+    // Пакет найденных файлов одного каталога; пути относительно корня обхода.
+    // Вызовы сериализованы, но идут из потоков обхода в произвольном порядке
+    using Sink = std::function<void(std::vector<std::string>& relativePaths)>;
+
+    explicit FileDiscovery(Options options);
+
+    // Обход root; бросает runtime_error, если root не каталог.
+    // Недоступные подкаталоги пропускаются и учитываются в SkippedDirectories
+    void Walk(const std::string& root, const Sink& sink);
+    // Все подходящие файлы, отсортированные по пути
+    std::vector<std::string> Discover(const std::string& root);
+
+    size_t DirectoryCount() const { return directoryCount; }
+    size_t SkippedDirectories() const { return skippedDirectories; }
+    size_t SkippedBySize() const { return skippedBySize; }
+
+private:
+    bool hasSupportedExtension(const char* name, size_t length) const;
+
+    Options options;
+    size_t directoryCount = 0;
+    size_t skippedDirectories = 0;
+    size_t skippedBySize = 0;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "DocumentTerms.h"
+
+// Потоковая индексация в три стадии, соединенные ограниченными очередями:
+// чтение документов (readerThreads потоков) -> токенизация (tokenizerThreads потоков) ->
+// построение индекса (вызывающий поток или shardCount потоков, см. RunSharded).
+// Чтение и токенизация перекрываются, а прочитанных, но еще не переданных в построение
+// документов одновременно не больше WindowSize(batchSize): читатели ждут, пока построение не догонит их.
+class IndexPipeline {
+public:
+    // Чтение текста документа по doc_id
+    using Reader = std::function<std::string(size_t doc_id)>;
+    // Чтение документов [begin, end) одним пакетом; texts уже имеет размер end - begin
+    using BatchReader = std::function<void(size_t begin, size_t end, std::vector<std::string>& texts)>;
+    // Прием документа; вызывается строго по возрастанию doc_id
+    using Sink = std::function<void(size_t doc_id, DocumentTerms& terms)>;
+    // Прием документа шардом построения: документ doc_id попадает в шард doc_id % shardCount.
+    // Каждый шард вызывается из своего потока, внутри шарда — строго по возрастанию doc_id
+    using ShardSink = std::function<void(size_t shard, size_t doc_id, DocumentTerms& terms)>;
+
+    // tokenizerThreads = 0 и readerThreads = 0 — по числу ядер;
+    // queueCapacity — емкость каждой очереди
+    explicit IndexPipeline(size_t tokenizerThreads = 0, size_t queueCapacity = 64,
+                           size_t readerThreads = 1);
+
+    // Первое исключение любой стадии останавливает конвейер и пробрасывается
+    void Run(size_t documentCount, const Reader& read, const Sink& sink);
+    // То же, но читатели забирают документы пакетами по batchSize doc_id
+    // (например, для асинхронного ввода-вывода с очередью запросов)
+    void RunBatched(size_t documentCount, const BatchReader& read, const Sink& sink,
+                    size_t batchSize);
+    // Построение в shardCount потоков: вызывающий поток восстанавливает порядок doc_id
+    // и раздает документы шардам через очереди емкостью queueCapacity.
+    // shardCount = 1 — то же, что RunBatched (sink вызывается в вызывающем потоке)
+    void RunSharded(size_t documentCount, const BatchReader& read, const ShardSink& sink,
+                    size_t batchSize, size_t shardCount);
+
+    // Наибольшее число документов в обработке до стадии построения: max(2 * queueCapacity, batchSize).
+    // В RunSharded к нему добавляются очереди шардов — не больше queueCapacity на шард
+    size_t WindowSize(size_t batchSize = 1) const;
+
+private:
+    size_t tokenizerThreads;
+    size_t queueCapacity;
+    size_t readerThreads;
+};
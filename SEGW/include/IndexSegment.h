@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "CompressedPostings.h"
+#include "Postings.h"
+
+// Версионированный двоичный сегмент индекса.
+//
+// Файл: заголовок SegmentHeader, затем секции (каждая выровнена на 8 байт):
+//   postings       — списки вхождений: Entry[] или сжатые байты (флаг kCompressed)
+//   postingOffsets — uint64[termCount + 1], смещения списков внутри postings в байтах
+//   termOffsets    — uint64[termCount + 1], смещения слов внутри termBytes
+//   termBytes      — байты всех слов подряд
+//   slots          — хеш-таблица SegmentSlot[slotCount] с открытой адресацией
+//   documents      — SegmentDocument[documentCount]: длина в байтах, число слов и флаги
+//                    (kRemovedDocument — документ удален, его вхождений в сегменте нет)
+//   sourceOffsets  — uint64[documentCount + 1], смещения путей внутри sourceBytes
+//   sourceBytes    — пути к исходным файлам документов подряд
+// Контрольная сумма FNV-1a считается по всем байтам после заголовка.
+struct SegmentHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t documentCount;
+    uint64_t termCount;
+    uint64_t slotCount;
+    uint64_t postingsOffset;
+    uint64_t postingsSize;
+    uint64_t postingOffsetsOffset;
+    uint64_t termOffsetsOffset;
+    uint64_t termBytesOffset;
+    uint64_t termBytesSize;
+    uint64_t slotsOffset;
+    uint64_t documentsOffset;
+    uint64_t sourceOffsetsOffset;
+    uint64_t sourceBytesOffset;
+    uint64_t sourceBytesSize;
+    uint64_t removedCount;
+    uint64_t fileSize;
+    uint64_t checksum;
+};
+
+struct SegmentSlot {
+    uint32_t hash;
+    uint32_t term_id;
+};
+
+struct SegmentDocument {
+    uint64_t length;
+    uint64_t tokenCount;
+    uint64_t flags;
+};
+
+// Запись сегмента потоком: списки вхождений пишутся сразу,
+// словарь и хеш-таблица — при Finish. Метаданные документов в памяти не копятся:
+// они пишутся во временные файлы <path>.docs и <path>.sources и копируются в сегмент при Finish
+class SegmentWriter {
+public:
+    static constexpr uint32_t kVersion = 3;
+    static constexpr uint32_t kCompressed = 1;
+    static constexpr uint64_t kRemovedDocument = 1;
+
+    SegmentWriter(const std::string& path, bool compressed);
+    ~SegmentWriter();
+
+    SegmentWriter(const SegmentWriter&) = delete;
+    SegmentWriter& operator=(const SegmentWriter&) = delete;
+
+    // Слова добавляются по порядку term_id
+    void AddTerm(std::string_view term, const std::vector<Entry>& entries);
+    // Потоковая запись списка: число вхождений известно заранее, вхождения подаются
+    // порциями по возрастанию doc_id и сразу пишутся в файл (в памяти — не больше блока)
+    void BeginTerm(std::string_view term, size_t postingCount);
+    void AppendPostings(PostingsView entries);
+    void EndTerm();
+    // Уже сжатый список (только для сжатого сегмента)
+    void AddEncodedTerm(std::string_view term, const uint8_t* data, size_t size);
+    // removed = true — документ удален (tombstone): doc_id занят, вхождений у него нет
+    void AddDocument(uint64_t length, uint64_t tokenCount = 0, std::string_view source = {},
+                     bool removed = false);
+
+    void Finish();
+
+private:
+    void addTermBytes(std::string_view term);
+    void write(const void* data, size_t size);
+    void align();
+    void discard();
+    void copySpill(std::FILE* spill, const std::string& spillPath, size_t recordSize, size_t offset,
+                   size_t size);
+
+    std::string path;
+    std::FILE* file = nullptr;
+    bool compressed;
+    bool finished = false;
+
+    uint64_t position = 0;
+    uint64_t checksum;
+    SegmentHeader header{};
+
+    std::vector<uint64_t> postingOffsets{0};
+    std::vector<uint64_t> termOffsets{0};
+    std::string termBytes;
+    std::vector<uint32_t> termHashes;
+    // Запись о документе во временном файле: SegmentDocument и конец его пути в sourceBytes
+    std::string documentsPath;
+    std::FILE* documentsFile = nullptr;
+    std::string sourcesPath;
+    std::FILE* sourcesFile = nullptr;
+    uint64_t documentCount = 0;
+    uint64_t sourceBytesSize = 0;
+    std::vector<uint8_t> encodeBuffer;
+    PostingEncoder encoder;
+    size_t termPostings = 0; // сколько вхождений текущего слова еще ожидается
+};
+
+// Сегмент, отображенный в память через mmap. Запросы выполняются
+// непосредственно по отображенным страницам, без загрузки в кучу.
+class IndexSegment {
+public:
+    static constexpr uint32_t kNoTerm = UINT32_MAX;
+
+    // Open всегда проверяет заголовок и структуру секций: смещения монотонны и не выходят
+    // за свои секции, слоты ссылаются на существующие слова (проход по словам, слотам и документам).
+    // verify = true (по умолчанию) — дополнительно прочитать весь файл: сверить контрольную сумму
+    // и проверить, что doc_id каждого списка возрастают и меньше числа документов.
+    // Поиск индексирует аккумуляторы по doc_id без проверок, поэтому verify = false
+    // допустимо только для файла, целостность которого уже подтверждена
+    static std::unique_ptr<IndexSegment> Open(const std::string& path, bool verify = true);
+    ~IndexSegment();
+
+    IndexSegment(const IndexSegment&) = delete;
+    IndexSegment& operator=(const IndexSegment&) = delete;
+
+    uint32_t FindTerm(std::string_view term) const;
+    std::string_view Term(uint32_t termId) const;
+
+    size_t TermCount() const { return header->termCount; }
+    size_t DocumentCount() const { return header->documentCount; }
+    uint64_t DocumentLength(size_t docId) const { return documents[docId].length; }
+    uint64_t DocumentTokenCount(size_t docId) const { return documents[docId].tokenCount; }
+    bool IsRemoved(size_t docId) const { return (documents[docId].flags & SegmentWriter::kRemovedDocument) != 0; }
+    size_t RemovedCount() const { return header->removedCount; }
+    std::string_view DocumentSource(size_t docId) const;
+    bool IsCompressed() const { return (header->flags & SegmentWriter::kCompressed) != 0; }
+
+    // Только для несжатого сегмента
+    PostingsView Postings(uint32_t termId) const;
+    PostingCursor Cursor(uint32_t termId) const;
+    size_t PostingCount(uint32_t termId) const;
+    size_t PostingBytes() const { return header->postingsSize; }
+
+    bool VerifyChecksum() const;
+
+private:
+    IndexSegment() = default;
+
+    bool layoutValid() const;
+    bool postingsValid() const;
+
+    const uint8_t* base = nullptr;
+    size_t mappedSize = 0;
+
+    const SegmentHeader* header = nullptr;
+    const uint8_t* postings = nullptr;
+    const uint64_t* postingOffsets = nullptr;
+    const uint64_t* termOffsets = nullptr;
+    const char* termBytes = nullptr;
+    const SegmentSlot* slots = nullptr;
+    const SegmentDocument* documents = nullptr;
+    const uint64_t* sourceOffsets = nullptr;
+    const char* sourceBytes = nullptr;
+};
@@ -1,36 +1,141 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
+#include "Postings.h"
+#include "CompressedPostings.h"
+#include "DocumentTerms.h"
+#include "IndexSegment.h"
+#include "TermDictionary.h"
+#include "Tokenizer.h"
 
 using namespace std;
 
-struct Entry {
-    size_t doc_id;
-    size_t count;
-
-    bool operator==(const Entry& other) const {
-        return doc_id == other.doc_id && count == other.count;
-    }
-};
-
 // Структура для статистики индекса
 struct IndexStats {
     size_t totalDocuments = 0;
     size_t totalWords = 0;
     size_t totalEntries = 0;
+    size_t postingBytes = 0; // память, занимаемая списками вхождений
+};
+
+// Сведения о документе; сам текст после индексации не хранится
+struct DocumentInfo {
+    uint64_t length = 0;     // длина текста в байтах
+    uint64_t tokenCount = 0; // число слов после нормализации
+    string source;           // путь к исходному файлу, если известен
 };
 
 class InvertedIndex {
 public:
-    void UpdateDocumentBase(const vector<string>& input_docs);
+    InvertedIndex() = default;
+    // thread_count = 0 — количество потоков по числу ядер
+    explicit InvertedIndex(size_t thread_count) : thread_count_(thread_count) {}
+
+    // Построение индекса заново. Тексты документов не копируются;
+    // sources (необязательно) — пути к исходным файлам по doc_id
+    void UpdateDocumentBase(const vector<string>& input_docs, const vector<string>& sources = {});
+    // То же, но тексты забираются и освобождаются сразу после индексации
+    void UpdateDocumentBase(vector<string>&& input_docs, const vector<string>& sources = {});
     vector<Entry> GetWordCount(const string& word) const;
-    size_t GetDocumentCount() const { return docs_.size(); }
-    bool ContainsWord(const string& word) const;
+    // Только для несжатого индекса; для сжатого используйте GetCursor
+    PostingsView GetPostings(string_view word) const;
+    PostingCursor GetCursor(string_view word) const;
+    // Размер пространства doc_id (включая удаленные документы)
+    size_t GetDocumentCount() const;
+    DocumentInfo GetDocumentInfo(size_t doc_id) const;
+    bool ContainsWord(string_view word) const;
     IndexStats GetStats() const;
 
+    // Инкрементальные изменения (только для несжатого индекса в памяти).
+    // Новый документ получает следующий doc_id и возвращает его
+    size_t AddDocument(const string& text, const string& source = "");
+    // Добавление уже токенизированного документа (стадия построения IndexPipeline)
+    size_t AddDocument(const DocumentTerms& terms, const string& source = "");
+    // Параллельное потоковое построение (стадия построения IndexPipeline::RunSharded):
+    // документы распределяются по частичным словарям, по одному на поток (как в UpdateDocumentBase).
+    // Возвращает число шардов; AddDocument для разных шардов можно вызывать одновременно,
+    // внутри шарда — по возрастанию doc_id
+    size_t BeginDocumentBase(size_t doc_count);
+    void AddDocument(size_t shard, size_t doc_id, const DocumentTerms& terms, const string& source = "");
+    // Завершение потокового построения: слияние шардов и сжатие списков, если оно включено
+    void FinishDocumentBase();
+    // Замена текста документа с сохранением его doc_id
+    void UpdateDocument(size_t doc_id, const string& text);
+    // Удаление документа пометкой (tombstone): doc_id не переиспользуется,
+    // вхождения пропускаются при чтении до вызова Compact
+    void RemoveDocument(size_t doc_id);
+    // Физическое удаление вхождений помеченных документов
+    void Compact();
+
+    bool HasRemovedDocuments() const { return removed_count_ > 0; }
+    bool IsRemoved(size_t doc_id) const { return doc_id < removed_.size() && removed_[doc_id]; }
+
+    void SetThreadCount(size_t thread_count) { thread_count_ = thread_count; }
+    // Хранить списки вхождений в сжатом виде (применяется при построении)
+    void SetCompression(bool enabled) { compress_postings_ = enabled; }
+    bool IsCompressed() const;
+
+    // Сохранение индекса в двоичный сегмент
+    void SaveSegment(const string& path) const;
+    // Загрузка сегмента через mmap: запросы выполняются по отображенным страницам.
+    // По умолчанию содержимое проверяется полностью (см. IndexSegment::Open)
+    void LoadSegment(const string& path, bool verify = true);
+    // Загрузка уже открытого сегмента
+    void LoadSegment(unique_ptr<IndexSegment> segment);
+
 private:
-    vector<string> docs_;
-    map<string, vector<Entry>> freq_dictionary_;
+    // Словарь терминов и списки вхождений, индексированные term_id
+    struct PostingStore {
+        TermDictionary terms;
+        vector<vector<Entry>> postings;
+
+        void Clear() {
+            terms.Clear();
+            postings.clear();
+        }
+    };
+
+    // Число вхождений слов текущего документа по term_id: плотный массив
+    // счетчиков и список затронутых term_id для сброса без полного прохода
+    struct TermCounts {
+        vector<uint32_t> counts;
+        vector<uint32_t> touched;
+    };
+
+    // Возвращает число слов документа
+    static size_t countWords(string_view text, Tokenizer& tokenizer,
+                             TermDictionary& terms, TermCounts& term_counts);
+    // Добавление подсчитанных вхождений документа в конец списков; счетчики сбрасываются
+    static void appendCounts(size_t doc_id, TermCounts& term_counts, PostingStore& out);
+    // owned — тот же вектор документов, если тексты можно освобождать сразу после индексации
+    static void indexRange(const vector<string>& docs, size_t begin, size_t end,
+                           PostingStore& out, vector<DocumentInfo>& infos, vector<string>* owned);
+    void buildDocumentBase(const vector<string>& docs, const vector<string>& sources,
+                           vector<string>* owned);
+    // Добавление токенизированного документа в конец списков out
+    static void appendTerms(size_t doc_id, const DocumentTerms& terms, PostingStore& out);
+    void clearDocumentBase(size_t doc_count);
+    void ensureMutable() const;
+    void purgeDocument(size_t doc_id);
+    size_t insertDocument(size_t doc_id, const string& text);
+    static void mergeInto(PostingStore& dst, PostingStore& src);
+    // Попарное слияние шардов по дереву; результат — в shards[0]
+    static void mergeShards(vector<PostingStore>& shards);
+    size_t resolveThreadCount(size_t doc_count) const;
+    void compressPostings();
+
+    vector<DocumentInfo> documents_;    // doc_id -> метаданные документа
+    PostingStore freq_dictionary_;
+    vector<PostingStore> build_shards_; // шарды потокового построения до FinishDocumentBase
+    TermCounts update_counts_;          // счетчики для AddDocument/UpdateDocument
+    CompressedPostings compressed_; // списки по term_id, если включено сжатие
+    unique_ptr<IndexSegment> segment_; // загруженный сегмент заменяет словари в памяти
+    vector<bool> removed_;              // doc_id -> документ удален
+    size_t removed_count_ = 0;
+    size_t thread_count_ = 0;
+    bool compress_postings_ = false;
 };
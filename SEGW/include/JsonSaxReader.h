@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// Однопроходный разбор JSON-документа через SAX-интерфейс nlohmann без полного DOM.
+// Смотрит только на ключи корневого объекта:
+//  - строки массивов, зарегистрированных через StreamStrings, передаются обработчику
+//    по одной прямо во время разбора (прочие элементы массива пропускаются);
+//  - значения, зарегистрированные через Keep, собираются в DOM — для небольших
+//    разделов вроде "config", чтобы проверять их как раньше;
+//  - все остальное пропускается без выделения памяти под значения.
+// Ошибки синтаксиса пробрасываются тем же nlohmann::json::parse_error, что и при
+// чтении через operator>>; как и operator>>, данные после документа не проверяются.
+class JsonSaxReader {
+public:
+    using StringSink = std::function<void(std::string& value)>;
+
+    void StreamStrings(const std::string& key, StringSink sink);
+    void Keep(const std::string& key);
+
+    void Parse(std::istream& input);
+
+    // Был ли в корневом объекте ключ, зарегистрированный через Keep или StreamStrings
+    bool Contains(const std::string& key) const;
+    // Собранное значение ключа из Keep; null, если ключа не было
+    const nlohmann::json& Kept(const std::string& key) const;
+    // Было ли значение ключа из StreamStrings массивом
+    bool WasArray(const std::string& key) const;
+
+private:
+    class Handler;
+
+    std::map<std::string, StringSink> streams;
+    std::map<std::string, nlohmann::json> kept;
+    std::map<std::string, bool> seen; // ключ -> значение было массивом
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+struct Entry {
+    size_t doc_id;
+    size_t count;
+
+    bool operator==(const Entry& other) const {
+        return doc_id == other.doc_id && count == other.count;
+    }
+};
+
+// Представление списка вхождений слова без копирования.
+// Действительно до следующего изменения индекса.
+class PostingsView {
+public:
+    PostingsView() = default;
+    PostingsView(const Entry* first, size_t size) : first_(first), size_(size) {}
+
+    const Entry* begin() const { return first_; }
+    const Entry* end() const { return first_ + size_; }
+    const Entry& operator[](size_t i) const { return first_[i]; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    const Entry* first_ = nullptr;
+    size_t size_ = 0;
+};
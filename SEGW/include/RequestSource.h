@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//Источник поисковых запросов, выдающий их по одному.
+//Файл с расширением .jsonl читается построчно (JSON Lines): каждая непустая строка —
+//JSON-строка с запросом или объект с полем "request". В памяти находится одна строка,
+//поэтому размер пакета запросов не ограничен памятью.
+//Остальные файлы читаются в прежнем формате {"requests": [...]} целиком.
+class RequestSource {
+public:
+    //Бросает runtime_error, если файл не открывается или (для .json) не разбирается
+    explicit RequestSource(const std::string& path);
+
+    //Следующий непустой запрос; false, когда запросы закончились.
+    //Некорректные строки JSONL пропускаются с предупреждением
+    bool Next(std::string& request);
+
+    bool IsStreaming() const { return jsonLines; }
+    //Число пропущенных некорректных строк JSONL
+    size_t SkippedLines() const { return skippedLines; }
+
+private:
+    bool parseLine(const std::string& line, std::string& request);
+
+    std::string path;
+    std::ifstream file;
+    bool jsonLines = false;
+    std::string line;
+    size_t lineNumber = 0;
+    size_t skippedLines = 0;
+    std::vector<std::string> loaded; //запросы файла .json
+    size_t position = 0;
+};
@@ -1,13 +1,23 @@
 #pragma once
 #include "InvertedIndex.h"
 #include "ConverterJSON.h"
+#include "ThreadPool.h"
+#include "Tokenizer.h"
 #include <vector>
 #include <string>
-#include <set>
+#include <string_view>
+#include <cstdint>
+#include <functional>
+#include <memory>
 
 //Класс для обработки поисковых запросов
 class SearchServer {
 public:
+    //Следующий запрос потока; false — запросы закончились
+    using RequestReader = std::function<bool(std::string& request)>;
+    //Результат запроса; вызывается строго по порядку запросов
+    using ResultSink = std::function<void(size_t requestIndex, std::vector<RelativeIndex>& results)>;
+
     //Структура для статистики поиска
     struct SearchStats {
         size_t totalQueries = 0;           // Общее количество запросов
@@ -16,22 +26,53 @@ public:
     };
 
 private:
-    static const size_t MAX_WORD_LENGTH = 100; 
+    static const size_t MAX_WORD_LENGTH = Tokenizer::kMaxWordLength; 
+
+    //Аккумуляторы релевантности одного запроса (подсчет term-at-a-time)
+    struct ScoreAccumulator {
+        std::vector<size_t> scores;    // doc_id -> абсолютная релевантность
+        std::vector<uint64_t> touched; // битовая карта затронутых документов
+        std::vector<std::pair<size_t, size_t>> top; // отобранные (doc_id, релевантность)
+
+        void Reset(size_t docCount);
+        void Add(size_t docId, size_t count);
+        //Отбирает k лучших документов (по убыванию релевантности, при равенстве —
+        //по возрастанию doc_id) в top и обнуляет буферы для следующего запроса
+        void SelectTop(size_t k);
+    };
+    
+    //Буферы, которые рабочий поток пула переиспользует между запросами одного вызова.
+    //Заводятся на каждый вызов search/searchStream, поэтому одновременные вызовы
+    //на одном SearchServer не делят буферы между собой
+    struct QueryScratch {
+        Tokenizer tokenizer;
+        std::vector<std::string_view> words;
+        ScoreAccumulator accumulator;
+    };
     
     InvertedIndex& index; 
-    std::string normalizeWord(const std::string& word) const;
-    std::vector<std::string> splitQuery(const std::string& query) const;
-    float calculateRelevance(const std::vector<std::string>& queryWords, 
-                            size_t docId) const;
+    std::unique_ptr<ThreadPool> pool;
+    //Нормализованные слова запроса без повторов; указывают в буфер tokenizer
+    void splitQuery(const std::string& query, Tokenizer& tokenizer,
+                    std::vector<std::string_view>& words) const;
     std::vector<RelativeIndex> processQuery(const std::string& query, 
-                                          size_t maxResponses) const;
+                                          size_t maxResponses,
+                                          QueryScratch& scratch) const;
 
 public:
-    SearchServer(InvertedIndex& idx);
+    //threadPoolSize = 0 — количество потоков по числу ядер
+    explicit SearchServer(InvertedIndex& idx, size_t threadPoolSize = 0);
     ~SearchServer();
     
     std::vector<std::vector<RelativeIndex>> search(
         const std::vector<std::string>& queries_input, 
         size_t maxResponses = 5) const;
     SearchStats getSearchStats(const std::vector<std::string>& queries_input) const;
+
+    //Потоковый поиск: отдельный поток читает запросы пакетами по batchSize в ограниченную
+    //очередь, пул обрабатывает пакет, результаты сразу уходят в sink. В памяти находится
+    //не больше нескольких пакетов запросов и результатов, сколько бы запросов ни было.
+    //Статистика собирается по ходу поиска; запрос с результатами — непустая выдача
+    SearchStats searchStream(const RequestReader& next, const ResultSink& sink,
+                             size_t maxResponses = 5, size_t batchSize = 1024) const;
 };
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DocumentTerms.h"
+#include "IndexSegment.h"
+#include "Postings.h"
+#include "TermDictionary.h"
+#include "Tokenizer.h"
+
+// Построение сегмента индекса в ограниченной памяти (SPIMI).
+// Документы индексируются в словарь в памяти; когда оценка занятой памяти
+// превышает бюджет, словарь сортируется по словам и сбрасывается во временный
+// файл (run). Finish сливает run-файлы k-путевым слиянием в итоговый сегмент;
+// если run-файлов больше kMaxMergeFanIn, слияние идет в несколько проходов.
+//
+// Слияние потоковое: списки читаются из run-файлов и пишутся в сегмент поблочно,
+// поэтому даже список самого частого слова целиком в памяти не собирается.
+//
+// Формат run-файла: для каждого слова по возрастанию — varint длины слова,
+// байты слова, список в формате CompressedPostings (varint числа вхождений, затем блоки).
+// Run-файлы создаются рядом с сегментом (<segment>.run<N>) и удаляются после слияния.
+class SpimiBuilder {
+public:
+    // Наибольшее число run-файлов, открытых одновременно при слиянии
+    static constexpr size_t kMaxMergeFanIn = 128;
+
+    SpimiBuilder(const std::string& segmentPath, size_t memoryBudgetBytes, bool compressed);
+    ~SpimiBuilder();
+
+    SpimiBuilder(const SpimiBuilder&) = delete;
+    SpimiBuilder& operator=(const SpimiBuilder&) = delete;
+
+    // Документы получают doc_id по порядку добавления
+    size_t AddDocument(std::string_view text, std::string_view source = {});
+    size_t AddDocument(const DocumentTerms& document, std::string_view source = {});
+    void Finish();
+
+    size_t DocumentCount() const { return documentCount; }
+    // Число run-файлов, сброшенных на диск (включая последний)
+    size_t RunCount() const { return runCount; }
+    // Память, занятая текущим словарем, по емкостям списков и таблиц. Метаданные
+    // документов (длины, пути) в памяти не хранятся — SegmentWriter сразу пишет их во временный файл
+    size_t MemoryUsage() const;
+
+private:
+    void flushRun();
+    std::string newRunPath();
+    void mergeRuns();
+    void removeRuns();
+
+    std::string segmentPath;
+    size_t memoryBudget;
+    bool compressed;
+    bool finished = false;
+
+    Tokenizer tokenizer;
+    DocumentTerms scratch;
+    TermDictionary terms;
+    std::vector<std::vector<Entry>> postings; // term_id -> вхождения текущего run
+    size_t postingBytes = 0;                  // сумма емкостей списков в postings
+
+    std::unique_ptr<SegmentWriter> writer; // создается сразу, списки пишутся при слиянии
+    size_t documentCount = 0;
+    std::vector<std::string> runPaths; // run-файлы на диске, включая промежуточные
+    size_t runCount = 0;
+    size_t runFileCount = 0;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Арена для строк: байты копируются в крупные блоки подряд и не перемещаются
+// до Clear, поэтому возвращенные string_view остаются действительными
+// и при росте арены, и при ее перемещении.
+class StringArena {
+public:
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    StringArena() = default;
+    StringArena(StringArena&&) noexcept = default;
+    StringArena& operator=(StringArena&&) noexcept = default;
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    std::string_view Store(std::string_view text);
+
+    // Байты, занятые строками, и выделенная под блоки память
+    size_t UsedBytes() const { return used_bytes_; }
+    size_t AllocatedBytes() const { return allocated_bytes_; }
+
+    void Clear();
+
+private:
+    char* allocate(size_t size);
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* cursor_ = nullptr;
+    size_t remaining_ = 0;
+    size_t used_bytes_ = 0;
+    size_t allocated_bytes_ = 0;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "StringArena.h"
+
+// Словарь терминов: сопоставляет каждому слову плотный 32-битный идентификатор.
+// Хеш-таблица с открытой адресацией (линейное пробирование), в слотах хранится
+// заранее вычисленный хеш, поэтому строки сравниваются только при совпадении хешей.
+// Каждое слово хранится один раз, байты всех слов лежат подряд в арене.
+class TermDictionary {
+public:
+    static constexpr uint32_t kNoTerm = UINT32_MAX;
+
+    // Идентификатор слова или kNoTerm, если слово отсутствует
+    uint32_t Find(std::string_view term) const;
+    // Идентификатор слова; новое слово получает следующий свободный идентификатор
+    uint32_t Intern(std::string_view term);
+
+    std::string_view Term(uint32_t term_id) const { return terms_[term_id]; }
+    size_t Size() const { return terms_.size(); }
+    bool Empty() const { return terms_.empty(); }
+    // Память под байты слов
+    size_t ByteSize() const { return arena_.AllocatedBytes(); }
+    // Вся выделенная словарем память: арена, хеш-таблица и массивы по term_id (по емкости)
+    size_t MemoryUsage() const {
+        return arena_.AllocatedBytes() + slots_.capacity() * sizeof(Slot) +
+               terms_.capacity() * sizeof(std::string_view) + hashes_.capacity() * sizeof(uint32_t);
+    }
+
+    void Reserve(size_t term_count);
+    void Clear();
+
+    static uint32_t Hash(std::string_view term);
+
+private:
+    struct Slot {
+        uint32_t hash;
+        uint32_t term_id;
+    };
+
+    size_t findSlot(std::string_view term, uint32_t hash) const;
+    void rehash(size_t slot_count);
+
+    std::vector<Slot> slots_;        // размер — степень двойки
+    StringArena arena_;                   // байты всех слов
+    std::vector<std::string_view> terms_; // term_id -> слово в арене
+    std::vector<uint32_t> hashes_;   // term_id -> хеш (для перестроения таблицы)
+};
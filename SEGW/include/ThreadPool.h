@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Пул потоков с перехватом задач (work stealing).
+//У каждого рабочего потока своя очередь: владелец берет задачи с конца,
+//простаивающие потоки забирают их с начала чужих очередей.
+class ThreadPool {
+public:
+    //Задача блока: [begin, end) и индекс выполняющего рабочего потока
+    using RangeTask = std::function<void(size_t begin, size_t end, size_t worker)>;
+
+    //threadCount = 0 — количество потоков по числу ядер
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t Size() const { return workers.size(); }
+
+    //Выполняет task над [0, count) блоками по chunkSize элементов и ждет завершения.
+    //Первое исключение из задач пробрасывается в вызывающий поток.
+    //Нельзя вызывать из задачи этого же пула.
+    void ParallelFor(size_t count, size_t chunkSize, const RangeTask& task);
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void(size_t)>> tasks;
+    };
+
+    void submit(std::function<void(size_t)> task);
+    bool tryPop(size_t worker, std::function<void(size_t)>& task);
+    bool trySteal(size_t worker, std::function<void(size_t)>& task);
+    void workerLoop(size_t worker);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<size_t> pendingTasks{0};
+    std::atomic<size_t> nextQueue{0};
+    bool stopping = false;
+};
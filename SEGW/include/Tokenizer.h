@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace TokenizerTables {
+
+// Классы байтов: kOther — отбрасывается, kSpace — разделитель,
+// иначе — буква в нижнем регистре
+constexpr uint8_t kOther = 0;
+constexpr uint8_t kSpace = 1;
+
+constexpr std::array<uint8_t, 256> MakeCharTable() {
+    std::array<uint8_t, 256> table{};
+    for (int c = 'a'; c <= 'z'; ++c) {
+        table[c] = static_cast<uint8_t>(c);
+    }
+    for (int c = 'A'; c <= 'Z'; ++c) {
+        table[c] = static_cast<uint8_t>(c - 'A' + 'a');
+    }
+    for (char c : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+        table[static_cast<unsigned char>(c)] = kSpace;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> kCharTable = MakeCharTable();
+
+} // namespace TokenizerTables
+
+// Разбиение текста на нормализованные слова за один проход.
+// Слова разделяются пробельными символами ASCII; внутри слова остаются только
+// буквы латиницы и кириллицы в UTF-8, приведенные к нижнему регистру
+// ("Don't" -> "dont", "Москва!" -> "москва"). Некорректные байты UTF-8 отбрасываются.
+// Слова выдаются как string_view во внутренний буфер без выделения памяти на каждое слово.
+// Классификация выполняется блоками по 64 байта векторным ядром (AVX2 или SSE2),
+// которое выбирается во время выполнения; результат совпадает со скалярным ядром.
+// Блоки с байтами вне ASCII повторно разбираются декодером UTF-8.
+class Tokenizer {
+public:
+    // Ограничение длины слова в байтах UTF-8
+    static constexpr size_t kMaxWordLength = 100;
+
+    enum class Kernel {
+        Auto,   // лучшее из доступных на данном процессоре
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    explicit Tokenizer(Kernel kernel = Kernel::Auto);
+
+    // Возвращаемые слова действительны до следующего вызова Tokenize
+    const std::vector<std::string_view>& Tokenize(std::string_view text);
+    const std::vector<std::string_view>& Tokens() const { return tokens_; }
+    // Слова последнего Tokenize, которые можно переупорядочить или отфильтровать на месте
+    // (например, отсортировать без копии); буфер переиспользуется следующим Tokenize
+    std::vector<std::string_view>& MutableTokens() { return tokens_; }
+
+    Kernel ActiveKernel() const { return kernel_; }
+    static bool IsSupported(Kernel kernel);
+
+private:
+    // Маски блока: бит i установлен, если байт i — разделитель /
+    // отбрасываемый символ / байт вне ASCII
+    struct BlockMasks {
+        uint64_t space;
+        uint64_t other;
+        uint64_t high;
+    };
+    // Пишет в dst буквы в нижнем регистре, остальные байты — нулями
+    using ClassifyFn = BlockMasks (*)(const unsigned char* src, size_t size, char* dst);
+
+    static BlockMasks classifyScalar(const unsigned char* src, size_t size, char* dst);
+    static BlockMasks classifySse2(const unsigned char* src, size_t size, char* dst);
+    static BlockMasks classifyAvx2(const unsigned char* src, size_t size, char* dst);
+    static ClassifyFn resolveKernel(Kernel& kernel);
+    // Разбор блока [block, block + size) с учетом UTF-8. Разбор начинается с sequence —
+    // начала последовательности, которая могла начаться в предыдущем блоке;
+    // на выходе sequence указывает на первую неразобранную последовательность.
+    BlockMasks classifyUtf8(std::string_view text, size_t block, size_t size, size_t& sequence);
+    void emitWord(size_t begin, size_t end, bool hasOther);
+
+    Kernel kernel_;
+    ClassifyFn classify_;
+    std::string buffer_;
+    std::vector<std::string_view> tokens_;
+};
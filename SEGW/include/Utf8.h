@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Разбор UTF-8 и приведение букв к нижнему регистру.
+// Буквами считаются латиница (ASCII и Latin-1 Supplement) и кириллица (U+0400–U+04FF).
+namespace Utf8 {
+
+// Состояния автомата проверки: число ожидаемых байтов продолжения
+// и особые состояния для запрета избыточных и суррогатных кодировок
+enum State : uint8_t {
+    kAccept = 0,
+    kNeed1,
+    kNeed2,
+    kNeed2AfterE0,  // E0: второй байт A0–BF
+    kNeed2AfterED,  // ED: второй байт 80–9F
+    kNeed3,
+    kNeed3AfterF0,  // F0: второй байт 90–BF
+    kNeed3AfterF4,  // F4: второй байт 80–8F
+    kReject,
+    kStateCount
+};
+
+// Классы байтов
+enum ByteClass : uint8_t {
+    kAscii = 0,
+    kCont80,     // 80–8F
+    kCont90,     // 90–9F
+    kContA0,     // A0–BF
+    kInvalid,    // C0–C1, F5–FF
+    kLead2,      // C2–DF
+    kLeadE0,
+    kLead3,      // E1–EC, EE–EF
+    kLeadED,
+    kLeadF0,
+    kLead4,      // F1–F3
+    kLeadF4,
+    kClassCount
+};
+
+constexpr std::array<uint8_t, 256> MakeByteClasses() {
+    std::array<uint8_t, 256> classes{};
+    for (int c = 0; c < 256; ++c) {
+        uint8_t cls = kInvalid;
+        if (c < 0x80) cls = kAscii;
+        else if (c < 0x90) cls = kCont80;
+        else if (c < 0xA0) cls = kCont90;
+        else if (c < 0xC0) cls = kContA0;
+        else if (c < 0xC2) cls = kInvalid;
+        else if (c < 0xE0) cls = kLead2;
+        else if (c == 0xE0) cls = kLeadE0;
+        else if (c == 0xED) cls = kLeadED;
+        else if (c < 0xF0) cls = kLead3;
+        else if (c == 0xF0) cls = kLeadF0;
+        else if (c < 0xF4) cls = kLead4;
+        else if (c == 0xF4) cls = kLeadF4;
+        classes[c] = cls;
+    }
+    return classes;
+}
+
+constexpr std::array<uint8_t, kStateCount * kClassCount> MakeTransitions() {
+    std::array<uint8_t, kStateCount * kClassCount> next{};
+    for (auto& state : next) {
+        state = kReject;
+    }
+    auto set = [&next](State from, ByteClass cls, State to) {
+        next[from * kClassCount + cls] = to;
+    };
+
+    set(kAccept, kAscii, kAccept);
+    set(kAccept, kLead2, kNeed1);
+    set(kAccept, kLeadE0, kNeed2AfterE0);
+    set(kAccept, kLead3, kNeed2);
+    set(kAccept, kLeadED, kNeed2AfterED);
+    set(kAccept, kLeadF0, kNeed3AfterF0);
+    set(kAccept, kLead4, kNeed3);
+    set(kAccept, kLeadF4, kNeed3AfterF4);
+
+    for (ByteClass cont : {kCont80, kCont90, kContA0}) {
+        set(kNeed1, cont, kAccept);
+        set(kNeed2, cont, kNeed1);
+        set(kNeed3, cont, kNeed2);
+    }
+    set(kNeed2AfterE0, kContA0, kNeed1);
+    set(kNeed2AfterED, kCont80, kNeed1);
+    set(kNeed2AfterED, kCont90, kNeed1);
+    set(kNeed3AfterF0, kCont90, kNeed2);
+    set(kNeed3AfterF0, kContA0, kNeed2);
+    set(kNeed3AfterF4, kCont80, kNeed2);
+    return next;
+}
+
+inline constexpr std::array<uint8_t, 256> kByteClass = MakeByteClasses();
+inline constexpr std::array<uint8_t, kStateCount * kClassCount> kTransition = MakeTransitions();
+
+// Кодовые точки, для которых ведется таблица регистра; все они
+// кодируются не более чем двумя байтами, и приведение не меняет длину
+constexpr char32_t kFoldLimit = 0x500;
+
+// Для буквы — ее строчная форма, для прочих символов — 0
+constexpr std::array<uint16_t, kFoldLimit> MakeFoldTable() {
+    std::array<uint16_t, kFoldLimit> fold{};
+    auto pairs = [&fold](char32_t first, char32_t last, bool upperEven) {
+        for (char32_t c = first; c <= last; ++c) {
+            const bool upper = (c % 2 == 0) == upperEven;
+            fold[c] = static_cast<uint16_t>(upper ? c + 1 : c);
+        }
+    };
+
+    for (char32_t c = 'a'; c <= 'z'; ++c) {
+        fold[c] = static_cast<uint16_t>(c);
+        fold[c - 0x20] = static_cast<uint16_t>(c);
+    }
+
+    // Latin-1 Supplement: ª µ º, À–Þ -> à–þ, ß и строчные; × и ÷ — не буквы
+    fold[0xAA] = 0xAA;
+    fold[0xB5] = 0xB5;
+    fold[0xBA] = 0xBA;
+    for (char32_t c = 0xC0; c <= 0xDE; ++c) {
+        if (c != 0xD7) {
+            fold[c] = static_cast<uint16_t>(c + 0x20);
+        }
+    }
+    for (char32_t c = 0xDF; c <= 0xFF; ++c) {
+        if (c != 0xF7) {
+            fold[c] = static_cast<uint16_t>(c);
+        }
+    }
+
+    // Кириллица: Ѐ–Џ -> ѐ–џ, А–Я -> а–я, далее пары «прописная, строчная»;
+    // U+0482–U+0489 — знаки и комбинируемые символы
+    for (char32_t c = 0x400; c <= 0x40F; ++c) {
+        fold[c] = static_cast<uint16_t>(c + 0x50);
+    }
+    for (char32_t c = 0x410; c <= 0x42F; ++c) {
+        fold[c] = static_cast<uint16_t>(c + 0x20);
+    }
+    for (char32_t c = 0x430; c <= 0x45F; ++c) {
+        fold[c] = static_cast<uint16_t>(c);
+    }
+    pairs(0x460, 0x481, true);
+    pairs(0x48A, 0x4BF, true);
+    fold[0x4C0] = 0x4CF;
+    pairs(0x4C1, 0x4CE, false);
+    fold[0x4CF] = 0x4CF;
+    pairs(0x4D0, 0x4FF, true);
+    return fold;
+}
+
+inline constexpr std::array<uint16_t, kFoldLimit> kFoldTable = MakeFoldTable();
+
+// Разбирает одну последовательность, не заглядывая дальше available байтов.
+// Возвращает ее длину или 0, если последовательность некорректна.
+size_t Decode(const unsigned char* data, size_t available, char32_t& codePoint);
+
+// Строчная форма буквы или 0, если символ не является буквой
+inline char32_t FoldLetter(char32_t codePoint) {
+    return codePoint < kFoldLimit ? kFoldTable[codePoint] : 0;
+}
+
+// Проверка корректности всей строки; ASCII проверяется по 8 байтов за шаг
+bool IsValid(std::string_view text);
+
+} // namespace Utf8
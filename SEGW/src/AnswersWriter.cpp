@@ -0,0 +1,529 @@
+#include "AnswersWriter.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <nlohmann/json.hpp>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// Буфер сбрасывается в файл блоками такого размера
+constexpr size_t kFlushThreshold = 1 << 20;
+
+void appendUnsigned(std::string& out, size_t value) {
+    char digits[24];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+// Запись double байт в байт как у nlohmann::json::dump: цифры Grisu2, ".0" у целых
+// значений, показатель вне диапазона 1e-4..1e15. std::to_chars здесь не подходит:
+// он выдает кратчайшие цифры и при равноудаленных вариантах округляет к четной,
+// а Grisu2 в части случаев дает другую последнюю цифру или лишнюю цифру.
+// Генератор цифр dump доступен только во внутреннем пространстве nlohmann::detail,
+// поэтому он используется лишь для проверенной ветки 3.x; для других версий
+// число сериализуется через публичный dump (медленнее, но результат тот же)
+void appendDouble(std::string& out, double value) {
+    if (!std::isfinite(value)) {
+        out += "null";
+        return;
+    }
+#if NLOHMANN_JSON_VERSION_MAJOR == 3
+    char buffer[64];
+    const char* end = nlohmann::detail::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, static_cast<size_t>(end - buffer));
+#else
+    out += nlohmann::json(value).dump();
+#endif
+}
+
+void appendIndent(std::string& out, AnswersWriter::Format format, size_t depth) {
+    if (format == AnswersWriter::Format::Pretty) {
+        out.push_back('\n');
+        out.append(depth * 4, ' ');
+    }
+}
+
+// Разделитель ключа и значения: ": " с отступами, ":" без них
+void appendKey(std::string& out, AnswersWriter::Format format, const char* key) {
+    out.push_back('"');
+    out += key;
+    out += format == AnswersWriter::Format::Pretty ? "\": " : "\":";
+}
+
+void appendEntry(std::string& out, AnswersWriter::Format format, size_t depth,
+                 const RelativeIndex& entry) {
+    appendIndent(out, format, depth);
+    appendKey(out, format, "docid");
+    appendUnsigned(out, entry.doc_id);
+    out.push_back(',');
+    appendIndent(out, format, depth);
+    appendKey(out, format, "rank");
+    appendDouble(out, static_cast<double>(entry.rank));
+}
+
+// Большие числа в CBOR и MessagePack записываются в порядке big-endian
+void appendBigEndian(std::string& out, uint64_t value, size_t bytes) {
+    for (size_t shift = bytes * 8; shift > 0; shift -= 8) {
+        out.push_back(static_cast<char>((value >> (shift - 8)) & 0xff));
+    }
+}
+
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// CBOR (RFC 8949): заголовок — старшие 3 бита тип, младшие 5 — длина или значение
+void appendCborHead(std::string& out, uint8_t major, uint64_t value) {
+    const uint8_t type = static_cast<uint8_t>(major << 5);
+    if (value < 24) {
+        out.push_back(static_cast<char>(type | value));
+    } else if (value <= 0xff) {
+        out.push_back(static_cast<char>(type | 24));
+        appendBigEndian(out, value, 1);
+    } else if (value <= 0xffff) {
+        out.push_back(static_cast<char>(type | 25));
+        appendBigEndian(out, value, 2);
+    } else if (value <= 0xffffffffu) {
+        out.push_back(static_cast<char>(type | 26));
+        appendBigEndian(out, value, 4);
+    } else {
+        out.push_back(static_cast<char>(type | 27));
+        appendBigEndian(out, value, 8);
+    }
+}
+
+void appendCborString(std::string& out, std::string_view text) {
+    appendCborHead(out, 3, text.size());
+    out.append(text);
+}
+
+void appendCborEntry(std::string& out, const RelativeIndex& entry) {
+    appendCborString(out, "docid");
+    appendCborHead(out, 0, entry.doc_id);
+    appendCborString(out, "rank");
+    out.push_back(static_cast<char>(0xfa)); // float32
+    appendBigEndian(out, floatBits(entry.rank), 4);
+}
+
+// MessagePack: короткие целые, строки, массивы и словари кодируются одним байтом
+void appendMsgpackUnsigned(std::string& out, uint64_t value) {
+    if (value < 0x80) {
+        out.push_back(static_cast<char>(value));
+    } else if (value <= 0xff) {
+        out.push_back(static_cast<char>(0xcc));
+        appendBigEndian(out, value, 1);
+    } else if (value <= 0xffff) {
+        out.push_back(static_cast<char>(0xcd));
+        appendBigEndian(out, value, 2);
+    } else if (value <= 0xffffffffu) {
+        out.push_back(static_cast<char>(0xce));
+        appendBigEndian(out, value, 4);
+    } else {
+        out.push_back(static_cast<char>(0xcf));
+        appendBigEndian(out, value, 8);
+    }
+}
+
+void appendMsgpackString(std::string& out, std::string_view text) {
+    if (text.size() < 32) {
+        out.push_back(static_cast<char>(0xa0 | text.size()));
+    } else {
+        out.push_back(static_cast<char>(0xd9));
+        appendBigEndian(out, text.size(), 1);
+    }
+    out.append(text);
+}
+
+void appendMsgpackArrayHead(std::string& out, size_t size) {
+    if (size < 16) {
+        out.push_back(static_cast<char>(0x90 | size));
+    } else if (size <= 0xffff) {
+        out.push_back(static_cast<char>(0xdc));
+        appendBigEndian(out, size, 2);
+    } else {
+        out.push_back(static_cast<char>(0xdd));
+        appendBigEndian(out, size, 4);
+    }
+}
+
+void appendMsgpackEntry(std::string& out, const RelativeIndex& entry) {
+    appendMsgpackString(out, "docid");
+    appendMsgpackUnsigned(out, entry.doc_id);
+    appendMsgpackString(out, "rank");
+    out.push_back(static_cast<char>(0xca)); // float32
+    appendBigEndian(out, floatBits(entry.rank), 4);
+}
+
+// Смещение числа ответов в заголовке MessagePack: 0x81, "answers", 0xdf
+constexpr size_t kMsgpackCountOffset = 1 + 1 + 7 + 1;
+
+// Ответ в двоичном формате: словарь из тех же ключей в том же порядке, что и в JSON
+void appendBinaryAnswer(std::string& out, size_t index, const std::vector<RelativeIndex>& results,
+                        size_t maxResponses, bool cbor) {
+    std::string requestId;
+    AnswersWriter::AppendRequestId(requestId, index);
+
+    const size_t responseCount = std::min(results.size(), maxResponses);
+    const size_t fields = responseCount == 1 ? 3 : responseCount > 1 ? 2 : 1;
+    if (cbor) {
+        appendCborString(out, requestId);
+        appendCborHead(out, 5, fields);
+    } else {
+        appendMsgpackString(out, requestId);
+        out.push_back(static_cast<char>(0x80 | fields));
+    }
+
+    auto appendKey = [&](std::string_view key) {
+        cbor ? appendCborString(out, key) : appendMsgpackString(out, key);
+    };
+    auto appendEntry = [&](const RelativeIndex& entry) {
+        cbor ? appendCborEntry(out, entry) : appendMsgpackEntry(out, entry);
+    };
+
+    if (responseCount == 1) {
+        appendEntry(results[0]);
+    } else if (responseCount > 1) {
+        appendKey("relevance");
+        cbor ? appendCborHead(out, 4, responseCount) : appendMsgpackArrayHead(out, responseCount);
+        for (size_t j = 0; j < responseCount; ++j) {
+            out.push_back(static_cast<char>(cbor ? 0xa2 : 0x82));
+            appendEntry(results[j]);
+        }
+    }
+    appendKey("result");
+    if (cbor) {
+        out.push_back(static_cast<char>(results.empty() ? 0xf4 : 0xf5));
+    } else {
+        out.push_back(static_cast<char>(results.empty() ? 0xc2 : 0xc3));
+    }
+}
+
+bool isBinary(AnswersWriter::Format format) {
+    return format == AnswersWriter::Format::Cbor || format == AnswersWriter::Format::MessagePack;
+}
+
+} // namespace
+
+AnswersWriter::AnswersWriter(const std::string& path, Format format, size_t maxResponses, size_t threads)
+    : path(path), format(format), maxResponses(maxResponses) {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create answers file: " + path);
+    }
+    if (threads != 1) {
+        pool = std::make_unique<ThreadPool>(threads);
+        if (pool->Size() <= 1) {
+            pool.reset();
+        }
+    }
+    buffer.reserve(kFlushThreshold + 4096);
+    if (format == Format::Cbor) {
+        // Число ответов заранее неизвестно: словарь неопределенной длины до 0xff
+        appendCborHead(buffer, 5, 1);
+        appendCborString(buffer, "answers");
+        buffer.push_back(static_cast<char>(0xbf));
+    } else if (format == Format::MessagePack) {
+        // Длина словаря обязательна: map32 с нулем, число дописывается в Finish
+        buffer.push_back(static_cast<char>(0x81));
+        appendMsgpackString(buffer, "answers");
+        buffer.push_back(static_cast<char>(0xdf));
+        appendBigEndian(buffer, 0, 4);
+    } else {
+        buffer += '{';
+        appendIndent(buffer, format, 1);
+        appendKey(buffer, format, "answers");
+        buffer += '{';
+    }
+}
+
+AnswersWriter::AnswersWriter(AnswersWriter&& other) noexcept
+    : fd(other.fd),
+      path(std::move(other.path)),
+      buffer(std::move(other.buffer)),
+      format(other.format),
+      maxResponses(other.maxResponses),
+      count(other.count),
+      finished(other.finished),
+      pool(std::move(other.pool)),
+      pending(std::move(other.pending)),
+      chunkBuffers(std::move(other.chunkBuffers)) {
+    other.fd = -1;
+}
+
+AnswersWriter::~AnswersWriter() {
+    if (fd >= 0 && !finished) {
+        try {
+            Finish();
+        } catch (...) {
+        }
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+void AnswersWriter::AppendRequestId(std::string& out, size_t index) {
+    out += "request";
+    const size_t number = index + 1;
+    if (number < 10) {
+        out += "00";
+    } else if (number < 100) {
+        out += '0';
+    }
+    appendUnsigned(out, number);
+}
+
+void AnswersWriter::AppendAnswer(std::string& out, size_t index, const std::vector<RelativeIndex>& results,
+                                 size_t maxResponses, Format format) {
+    if (isBinary(format)) {
+        appendBinaryAnswer(out, index, results, maxResponses, format == Format::Cbor);
+        return;
+    }
+    if (index > 0) {
+        out.push_back(',');
+    }
+    appendIndent(out, format, 2);
+    out.push_back('"');
+    AppendRequestId(out, index);
+    out += format == Format::Pretty ? "\": {" : "\":{";
+
+    // Ограничиваем количество результатов согласно max_responses
+    const size_t responseCount = std::min(results.size(), maxResponses);
+    if (responseCount == 1) {
+        // Единственный результат записывается полями самого ответа
+        appendEntry(out, format, 3, results[0]);
+        out.push_back(',');
+    } else if (responseCount > 1) {
+        appendIndent(out, format, 3);
+        appendKey(out, format, "relevance");
+        out.push_back('[');
+        for (size_t j = 0; j < responseCount; ++j) {
+            if (j > 0) {
+                out.push_back(',');
+            }
+            appendIndent(out, format, 4);
+            out.push_back('{');
+            appendEntry(out, format, 5, results[j]);
+            appendIndent(out, format, 4);
+            out.push_back('}');
+        }
+        appendIndent(out, format, 3);
+        out += "],";
+    }
+    appendIndent(out, format, 3);
+    appendKey(out, format, "result");
+    out += results.empty() ? "false" : "true";
+    appendIndent(out, format, 2);
+    out.push_back('}');
+}
+
+void AnswersWriter::Add(const std::vector<RelativeIndex>& results) {
+    if (pool) {
+        Add(std::vector<RelativeIndex>(results));
+        return;
+    }
+    if (finished) {
+        throw std::logic_error("AnswersWriter::Add after Finish");
+    }
+    AppendAnswer(buffer, count++, results, maxResponses, format);
+    if (buffer.size() >= kFlushThreshold) {
+        flush();
+    }
+}
+
+void AnswersWriter::Add(std::vector<RelativeIndex>&& results) {
+    if (!pool) {
+        Add(static_cast<const std::vector<RelativeIndex>&>(results));
+        return;
+    }
+    if (finished) {
+        throw std::logic_error("AnswersWriter::Add after Finish");
+    }
+    pending.push_back(std::move(results));
+    if (pending.size() >= parallelRound()) {
+        flushPending();
+    }
+}
+
+void AnswersWriter::AddAll(const std::vector<std::vector<RelativeIndex>>& answers) {
+    if (!pool) {
+        for (const auto& results : answers) {
+            Add(results);
+        }
+        return;
+    }
+    if (finished) {
+        throw std::logic_error("AnswersWriter::AddAll after Finish");
+    }
+    flushPending();
+    for (size_t begin = 0; begin < answers.size(); begin += parallelRound()) {
+        writeParallel(answers, begin, std::min(answers.size(), begin + parallelRound()));
+    }
+}
+
+void AnswersWriter::flushPending() {
+    if (!pending.empty()) {
+        writeParallel(pending, 0, pending.size());
+        pending.clear();
+    }
+}
+
+void AnswersWriter::writeParallel(const std::vector<std::vector<RelativeIndex>>& answers,
+                                  size_t begin, size_t end) {
+    // Номер запроса известен заранее, поэтому куски форматируются независимо
+    const size_t firstIndex = count;
+    const size_t chunks = (end - begin + kChunkSize - 1) / kChunkSize;
+    if (chunkBuffers.size() < chunks) {
+        chunkBuffers.resize(chunks);
+    }
+    pool->ParallelFor(chunks, 1, [&](size_t chunkBegin, size_t chunkEnd, size_t) {
+        for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk) {
+            std::string& out = chunkBuffers[chunk];
+            out.clear();
+            const size_t from = begin + chunk * kChunkSize;
+            const size_t to = std::min(end, from + kChunkSize);
+            for (size_t i = from; i < to; ++i) {
+                AppendAnswer(out, firstIndex + (i - begin), answers[i], maxResponses, format);
+            }
+        }
+    });
+    count += end - begin;
+
+    std::vector<iovec> parts;
+    parts.reserve(chunks + 1);
+    if (!buffer.empty()) {
+        parts.push_back({buffer.data(), buffer.size()});
+    }
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        parts.push_back({chunkBuffers[chunk].data(), chunkBuffers[chunk].size()});
+    }
+    writeAll(parts);
+    buffer.clear();
+}
+
+void AnswersWriter::writeAll(std::vector<iovec>& parts) {
+    size_t first = 0;
+    while (first < parts.size()) {
+        const int batch = static_cast<int>(std::min<size_t>(parts.size() - first, IOV_MAX));
+        const ssize_t written = ::writev(fd, parts.data() + first, batch);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Error writing answers file: " + path);
+        }
+        // Пропускаем записанные части, у частично записанной сдвигаем начало
+        size_t remaining = static_cast<size_t>(written);
+        while (first < parts.size() && remaining >= parts[first].iov_len) {
+            remaining -= parts[first].iov_len;
+            ++first;
+        }
+        if (remaining > 0) {
+            parts[first].iov_base = static_cast<char*>(parts[first].iov_base) + remaining;
+            parts[first].iov_len -= remaining;
+        }
+    }
+}
+
+void AnswersWriter::flush() {
+    std::vector<iovec> parts{{buffer.data(), buffer.size()}};
+    writeAll(parts);
+    buffer.clear();
+}
+
+void AnswersWriter::Finish() {
+    if (finished) {
+        return;
+    }
+    flushPending();
+    finished = true;
+    if (format == Format::Cbor) {
+        buffer.push_back(static_cast<char>(0xff));
+    } else if (format != Format::MessagePack) {
+        if (count > 0) {
+            appendIndent(buffer, format, 1);
+        }
+        buffer += '}';
+        appendIndent(buffer, format, 0);
+        buffer += '}';
+    }
+    flush();
+    if (format == Format::MessagePack) {
+        if (count > 0xffffffffu) {
+            throw std::runtime_error("Too many answers for MessagePack: " + path);
+        }
+        std::string size;
+        appendBigEndian(size, count, 4);
+        if (::pwrite(fd, size.data(), size.size(), static_cast<off_t>(kMsgpackCountOffset)) !=
+            static_cast<ssize_t>(size.size())) {
+            throw std::runtime_error("Error writing answers file: " + path);
+        }
+    }
+    const int result = ::close(fd);
+    fd = -1;
+    if (result != 0) {
+        throw std::runtime_error("Error writing answers file: " + path);
+    }
+}
+
+std::vector<std::vector<RelativeIndex>> AnswersWriter::Read(const std::string& path, Format format) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open answers file: " + path);
+    }
+    const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    nlohmann::json document;
+    try {
+        if (format == Format::Cbor) {
+            document = nlohmann::json::from_cbor(bytes);
+        } else if (format == Format::MessagePack) {
+            document = nlohmann::json::from_msgpack(bytes);
+        } else {
+            document = nlohmann::json::parse(bytes);
+        }
+    } catch (const nlohmann::json::exception& e) {
+        throw std::runtime_error("Invalid answers file " + path + ": " + e.what());
+    }
+    if (!document.is_object() || !document.contains("answers") || !document["answers"].is_object()) {
+        throw std::runtime_error("Invalid answers file " + path + ": missing 'answers' object");
+    }
+
+    // Ключи словаря упорядочены как строки ("request1000" раньше "request101"),
+    // поэтому позиция ответа берется из номера запроса
+    const nlohmann::json& answers = document["answers"];
+    std::vector<std::vector<RelativeIndex>> result(answers.size());
+    for (const auto& [key, answer] : answers.items()) {
+        size_t number = 0;
+        const char* digits = key.c_str() + std::min<size_t>(key.size(), 7);
+        const auto parsed = std::from_chars(digits, key.c_str() + key.size(), number);
+        if (key.compare(0, 7, "request") != 0 || parsed.ec != std::errc() || number == 0 ||
+            number > result.size()) {
+            throw std::runtime_error("Invalid answers file " + path + ": unexpected key " + key);
+        }
+        std::vector<RelativeIndex>& results = result[number - 1];
+        auto readEntry = [&results](const nlohmann::json& entry) {
+            results.emplace_back(entry.at("docid").get<size_t>(), entry.at("rank").get<float>());
+        };
+        if (answer.contains("relevance")) {
+            for (const auto& entry : answer["relevance"]) {
+                readEntry(entry);
+            }
+        } else if (answer.contains("docid")) {
+            readEntry(answer);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,139 @@
+#include "CompressedPostings.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Чтение varint не дальше end; обрыв списка — ошибка, а не чтение чужой памяти
+uint64_t readVarint(const uint8_t*& data, const uint8_t* end) {
+    if (data == end) {
+        throw std::runtime_error("Truncated compressed postings list");
+    }
+    uint64_t value = *data++;
+    if (value < 0x80) {
+        return value; // самый частый случай — один байт
+    }
+
+    value &= 0x7f;
+    for (unsigned shift = 7; shift < 64; shift += 7) {
+        if (data == end) {
+            throw std::runtime_error("Truncated compressed postings list");
+        }
+        const uint8_t byte = *data++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Malformed varint in compressed postings list");
+}
+
+} // namespace
+
+PostingCursor::PostingCursor(const uint8_t* data, const uint8_t* end) : data_(data), end_(end) {
+    if (data_ != end_) {
+        remaining_ = readVarint(data_, end_);
+    }
+}
+
+bool PostingCursor::Next() {
+    if (rawPending_) {
+        rawPending_ = false;
+        block_ = raw_;
+        return true;
+    }
+    if (remaining_ == 0) {
+        block_ = PostingsView();
+        return false;
+    }
+
+    const size_t count = std::min(remaining_, kBlockSize);
+
+    size_t docId = lastDocId_;
+    for (size_t i = 0; i < count; ++i) {
+        docId += readVarint(data_, end_);
+        buffer_[i].doc_id = docId;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        buffer_[i].count = readVarint(data_, end_) + 1;
+    }
+
+    lastDocId_ = docId;
+    remaining_ -= count;
+    block_ = PostingsView(buffer_, count);
+    return true;
+}
+
+void PostingEncoder::Begin(size_t count, std::vector<uint8_t>& out) {
+    remaining_ = count;
+    lastDocId_ = 0;
+    pending_ = 0;
+    writeVarint(out, count);
+}
+
+void PostingEncoder::Add(PostingsView entries, std::vector<uint8_t>& out) {
+    if (entries.size() > remaining_) {
+        throw std::logic_error("More postings than declared for the list");
+    }
+    remaining_ -= entries.size();
+
+    for (const Entry& entry : entries) {
+        block_[pending_++] = entry;
+        if (pending_ == PostingCursor::kBlockSize) {
+            flushBlock(out);
+        }
+    }
+}
+
+void PostingEncoder::End(std::vector<uint8_t>& out) {
+    if (remaining_ != 0) {
+        throw std::logic_error("Fewer postings than declared for the list");
+    }
+    flushBlock(out);
+}
+
+// Блок: разности doc_id, затем значения count - 1
+void PostingEncoder::flushBlock(std::vector<uint8_t>& out) {
+    for (size_t i = 0; i < pending_; ++i) {
+        writeVarint(out, block_[i].doc_id - lastDocId_);
+        lastDocId_ = block_[i].doc_id;
+    }
+    for (size_t i = 0; i < pending_; ++i) {
+        writeVarint(out, block_[i].count - 1);
+    }
+    pending_ = 0;
+}
+
+void CompressedPostings::Encode(const std::vector<Entry>& entries, std::vector<uint8_t>& out) {
+    PostingEncoder encoder;
+    encoder.Begin(entries.size(), out);
+    encoder.Add(PostingsView(entries.data(), entries.size()), out);
+    encoder.End(out);
+}
+
+size_t CompressedPostings::EncodedCount(const uint8_t* data, const uint8_t* end) {
+    return readVarint(data, end);
+}
+
+void CompressedPostings::Append(const std::vector<Entry>& entries) {
+    Encode(entries, bytes_);
+    offsets_.push_back(bytes_.size());
+}
+
+void CompressedPostings::Clear() {
+    bytes_.clear();
+    offsets_.assign(1, 0);
+}
+
+// Число вхождений хранится в начале списка
+size_t CompressedPostings::PostingCount(size_t list) const {
+    return EncodedCount(bytes_.data() + offsets_[list], bytes_.data() + offsets_[list + 1]);
+}
@@ -1,25 +1,42 @@
 #include "ConverterJSON.h"
+#include "AnswersWriter.h"
+#include "FileDiscovery.h"
+#include "JsonSaxReader.h"
+#include "ThreadPool.h"
+#include "UringReader.h"
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Сообщения о загрузке документов из разных потоков не перемешиваются
+std::mutex logMutex;
+
+} // namespace
 
 // Конструктор
-ConverterJSON::ConverterJSON() : max_responses(5), auto_discover_files(false), max_files_to_process(10), resources_directory("resources") {
+ConverterJSON::ConverterJSON() : max_responses(5), auto_discover_files(false), max_files_to_process(10), resources_directory("resources"), supported_extensions{".txt", ".md"}, max_file_size_mb(10), thread_pool_size(4), compress_postings(false), index_memory_budget_mb(0), loader_threads(4), io_backend("threads"), requests_file("requests.json"), compact_answers(false), answers_format("json"), pathResolutionMs(0) {
+    initSearchPrefixes();
     loadConfig();
 }
 
 // Деструктор
 ConverterJSON::~ConverterJSON() {}
 
-// Поиск файла в возможных локациях
-std::string ConverterJSON::findFile(const std::string& filename) const {
+// Каталоги поиска файлов в порядке приоритета
+void ConverterJSON::initSearchPrefixes() {
     // Получаем путь к исполняемому файлу
     std::string executablePath = std::filesystem::current_path();
     
-    // Определяем базовую директорию проекта
-    std::string projectRoot;
-    
     // Если мы в папке build, поднимаемся на уровень выше
     if (executablePath.length() >= 6 && 
         (executablePath.substr(executablePath.length() - 6) == "/build" ||
@@ -35,33 +52,79 @@ std::string ConverterJSON::findFile(const std::string& filename) const {
         }
     }
     
-    std::vector<std::string> searchPaths = {
-        filename,                                    // Текущая директория
-        "./" + filename,                            // Явно текущая директория
-        "../" + filename,                           // Родительская директория
-        "../../" + filename,                        // На два уровня выше
-        projectRoot + "/" + filename,               // В корне проекта
-        projectRoot + "/JSON/" + filename,          // В папке JSON проекта
-        projectRoot + "/resources/" + filename,      // В папке resources проекта
-        "./JSON/" + filename,                       // В поддиректории JSON
-        "../JSON/" + filename,                      // JSON в родительской
-        "./config/" + filename,                     // В поддиректории config
-        "../config/" + filename,                    // config в родительской
-        "../../JSON/" + filename,                   // JSON на два уровня выше
-        "../../resources/" + filename                // resources на два уровня выше
+    searchPrefixes = {
+        "",                                         // Текущая директория
+        "../",                                      // Родительская директория
+        "../../",                                   // На два уровня выше
+        projectRoot + "/",                          // В корне проекта
+        projectRoot + "/JSON/",                     // В папке JSON проекта
+        projectRoot + "/resources/",                // В папке resources проекта
+        "./JSON/",                                  // В поддиректории JSON
+        "../JSON/",                                 // JSON в родительской
+        "./config/",                                // В поддиректории config
+        "../config/",                               // config в родительской
+        "../../JSON/",                              // JSON на два уровня выше
+        "../../resources/"                          // resources на два уровня выше
     };
+}
 
-    for (const auto& path : searchPaths) {
-        if (std::filesystem::exists(path)) {
-            return path;
+bool ConverterJSON::locateFile(const std::string& filename, size_t& prefixHint,
+                               std::string& resolved) const {
+    std::error_code error;
+    if (prefixHint < searchPrefixes.size()) {
+        resolved = searchPrefixes[prefixHint] + filename;
+        if (std::filesystem::exists(resolved, error)) {
+            return true;
         }
     }
+    for (size_t i = 0; i < searchPrefixes.size(); ++i) {
+        if (i == prefixHint) {
+            continue;
+        }
+        resolved = searchPrefixes[i] + filename;
+        if (std::filesystem::exists(resolved, error)) {
+            prefixHint = i;
+            return true;
+        }
+    }
+    resolved.clear();
+    return false;
+}
+
+// Поиск файла в возможных локациях
+std::string ConverterJSON::findFile(const std::string& filename) const {
+    size_t prefixHint = 0;
+    std::string resolved;
+    if (locateFile(filename, prefixHint, resolved)) {
+        return resolved;
+    }
 
     throw std::runtime_error("File not found: " + filename +
                            ". Searched in multiple locations including: " + 
                            projectRoot + "/JSON/");
 }
 
+// Пути документов ищутся один раз: чтение затем открывает файлы без повторных проверок.
+// Куски списка обрабатываются параллельно, каждый со своей подсказкой каталога
+void ConverterJSON::resolveDocumentPaths() {
+    auto startTime = std::chrono::steady_clock::now();
+    resolvedPaths.assign(filePaths.size(), std::string());
+
+    ThreadPool pool(loader_threads == 0 ? 0 : std::min(loader_threads, filePaths.size()));
+    pool.ParallelFor(filePaths.size(), 1024, [this](size_t begin, size_t end, size_t) {
+        size_t prefixHint = 0;
+        std::string resolved;
+        for (size_t i = begin; i < end; ++i) {
+            if (locateFile(filePaths[i], prefixHint, resolved)) {
+                resolvedPaths[i] = std::filesystem::absolute(resolved).lexically_normal().string();
+            }
+        }
+    });
+
+    pathResolutionMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - startTime).count();
+}
+
 // Загрузка конфигурации
 void ConverterJSON::loadConfig() {
     try {
@@ -72,15 +135,21 @@ void ConverterJSON::loadConfig() {
             throw std::runtime_error("Cannot open config file: " + configPath);
         }
 
-        nlohmann::json configJson;
-        configFile >> configJson;
+        // Однопроходный разбор: раздел "config" собирается целиком (он невелик),
+        // список "files" сразу переносится в filePaths, остальное пропускается
+        JsonSaxReader reader;
+        reader.Keep("config");
+        reader.StreamStrings("files", [this](std::string& file) {
+            filePaths.push_back(std::move(file));
+        });
+        reader.Parse(configFile);
 
         // ИСПРАВЛЕНИЕ: Проверка наличия обязательного поля "name"
-        if (!configJson.contains("config")) {
+        if (!reader.Contains("config")) {
             throw std::runtime_error("Missing 'config' section in config.json");
         }
 
-        auto config = configJson["config"];
+        const nlohmann::json& config = reader.Kept("config");
 
         if (!config.contains("name")) {
             throw std::runtime_error("Missing required field 'name' in config.json");
@@ -107,6 +176,52 @@ void ConverterJSON::loadConfig() {
             }
         }
 
+        if (config.contains("thread_pool_size")) {
+            thread_pool_size = config["thread_pool_size"].get<size_t>();
+        }
+
+        if (config.contains("compress_postings")) {
+            compress_postings = config["compress_postings"].get<bool>();
+        }
+
+        if (config.contains("index_segment")) {
+            index_segment = config["index_segment"].get<std::string>();
+        }
+
+        if (config.contains("index_memory_budget_mb")) {
+            index_memory_budget_mb = config["index_memory_budget_mb"].get<size_t>();
+        }
+
+        if (config.contains("loader_threads")) {
+            loader_threads = config["loader_threads"].get<size_t>();
+        }
+
+        if (config.contains("io_backend")) {
+            io_backend = config["io_backend"].get<std::string>();
+            if (io_backend != "threads" && io_backend != "io_uring") {
+                throw std::runtime_error("Unknown io_backend: " + io_backend);
+            }
+            if (io_backend == "io_uring" && !UringReader::IsAvailable()) {
+                std::cerr << "Warning: io_uring is not available, using threads backend" << std::endl;
+                io_backend = "threads";
+            }
+        }
+
+        if (config.contains("requests_file")) {
+            requests_file = config["requests_file"].get<std::string>();
+        }
+
+        if (config.contains("compact_answers")) {
+            compact_answers = config["compact_answers"].get<bool>();
+        }
+
+        if (config.contains("answers_format")) {
+            answers_format = config["answers_format"].get<std::string>();
+            if (answers_format != "json" && answers_format != "cbor" && answers_format != "msgpack") {
+                throw std::runtime_error("Unknown answers_format: " + answers_format);
+            }
+        }
+
         // Загрузка новых параметров
         if (config.contains("auto_discover_files")) {
             auto_discover_files = config["auto_discover_files"].get<bool>();
@@ -120,34 +235,70 @@ void ConverterJSON::loadConfig() {
             resources_directory = config["resources_directory"].get<std::string>();
         }
 
-        // Загрузка списка файлов или автоматическое обнаружение
+        if (config.contains("supported_extensions")) {
+            supported_extensions = config["supported_extensions"].get<std::vector<std::string>>();
+        }
+
+        if (config.contains("max_file_size_mb")) {
+            max_file_size_mb = config["max_file_size_mb"].get<size_t>();
+        }
+
+        // Загрузка списка файлов или автоматическое обнаружение.
+        // Старый способ — список files, уже прочитанный при разборе
         if (auto_discover_files) {
+            filePaths.clear();
+            filePaths.shrink_to_fit();
             discoverFiles();
-        } else {
-            // Старый способ - загрузка из списка files
-            if (configJson.contains("files") && configJson["files"].is_array()) {
-                for (const auto& file : configJson["files"]) {
-                    if (file.is_string()) {
-                        filePaths.push_back(file.get<std::string>());
-                    }
-                }
-            }
         }
 
         if (filePaths.empty()) {
             throw std::runtime_error("No files found for processing");
         }
 
+        if (resolvedPaths.size() != filePaths.size()) {
+            resolveDocumentPaths();
+        }
+        const size_t unresolved = std::count(resolvedPaths.begin(), resolvedPaths.end(), std::string());
+
         std::cout << "Configuration loaded successfully:" << std::endl;
         std::cout << "  Name: " << appName << std::endl;
         std::cout << "  Version: " << version << std::endl;
         std::cout << "  Max responses: " << max_responses << std::endl;
+        std::cout << "  Thread pool size: " << thread_pool_size << std::endl;
+        std::cout << "  Loader threads: " << loader_threads << std::endl;
+        std::cout << "  IO backend: " << io_backend << std::endl;
+        std::cout << "  Requests file: " << requests_file << std::endl;
+        std::cout << "  Answers format: " << answers_format;
+        if (answers_format == "json" && compact_answers) {
+            std::cout << " (compact)";
+        }
+        std::cout << std::endl;
+        std::cout << "  Compress postings: " << (compress_postings ? "enabled" : "disabled") << std::endl;
+        if (!index_segment.empty()) {
+            std::cout << "  Index segment: " << index_segment << std::endl;
+        }
+        if (index_memory_budget_mb > 0) {
+            std::cout << "  Index memory budget: " << index_memory_budget_mb << " MB" << std::endl;
+        }
         std::cout << "  Auto discover files: " << (auto_discover_files ? "enabled" : "disabled") << std::endl;
         if (auto_discover_files) {
             std::cout << "  Max files to process: " << max_files_to_process << std::endl;
             std::cout << "  Resources directory: " << resources_directory << std::endl;
+            std::cout << "  Supported extensions:";
+            for (const auto& ext : supported_extensions) {
+                std::cout << " " << ext;
+            }
+            std::cout << std::endl;
+            if (max_file_size_mb > 0) {
+                std::cout << "  Max file size: " << max_file_size_mb << " MB" << std::endl;
+            }
         }
         std::cout << "  Files count: " << filePaths.size() << std::endl;
+        std::cout << "  Path resolution: " << pathResolutionMs << " ms";
+        if (unresolved > 0) {
+            std::cout << " (" << unresolved << " files not found)";
+        }
+        std::cout << std::endl;
 
     } catch (const std::exception& e) {
         std::cerr << "Error loading config: " << e.what() << std::endl;
@@ -155,129 +306,240 @@ void ConverterJSON::loadConfig() {
     }
 }
 
-// Получение списка файлов для индексации
+// Получение списка файлов для индексации.
+// Файлы читаются параллельно в loader_threads потоков, порядок документов сохраняется
 std::vector<std::string> ConverterJSON::GetTextDocuments() const {
-    std::vector<std::string> documents;
-    documents.reserve(filePaths.size());
-
-    for (size_t i = 0; i < filePaths.size(); ++i) {
-        try {
-            std::string fullPath = findFile(filePaths[i]);
-            std::ifstream file(fullPath);
-
-            if (!file.is_open()) {
-                std::cerr << "Warning: Cannot open file: " << filePaths[i] << std::endl;
-                documents.push_back(""); // Добавляем пустой документ
-                continue;
-            }
+    std::vector<std::string> documents(filePaths.size());
+    if (filePaths.empty()) {
+        return documents;
+    }
 
-            std::string content;
-            std::string line;
+    ThreadPool pool(loader_threads == 0 ? 0 : std::min(loader_threads, filePaths.size()));
+    pool.ParallelFor(filePaths.size(), 16, [this, &documents](size_t begin, size_t end, size_t) {
+        std::vector<std::string> texts(end - begin);
+        ReadDocuments(begin, end, texts);
+        std::move(texts.begin(), texts.end(), documents.begin() + begin);
+    });
 
-            while (std::getline(file, line)) {
-                content += line + " ";
-            }
+    return documents;
+}
 
-            documents.push_back(content);
-            std::cout << "Loaded document " << i << ": " << filePaths[i]
-                     << " (" << content.length() << " chars)" << std::endl;
+bool ConverterJSON::readWholeFile(const std::string& path, std::string& content) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
 
-        } catch (const std::exception& e) {
-            std::cerr << "Error reading file " << filePaths[i] << ": " << e.what() << std::endl;
-            documents.push_back(""); // Добавляем пустой документ
+    // Буфер выделяется один раз по размеру файла; обычно хватает одного read
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    content.resize(static_cast<size_t>(info.st_size));
+
+    size_t total = 0;
+    while (total < content.size()) {
+        const ssize_t got = ::read(fd, content.data() + total, content.size() - total);
+        if (got < 0) {
+            ::close(fd);
+            return false;
         }
+        if (got == 0) {
+            break; // файл укоротился во время чтения
+        }
+        total += static_cast<size_t>(got);
     }
+    ::close(fd);
+    content.resize(total);
+    normalizeLineBreaks(content);
+    return true;
+}
 
-    return documents;
+void ConverterJSON::normalizeLineBreaks(std::string& content) {
+    // Прежнее построчное чтение добавляло пробел после каждой строки,
+    // в том числе после последней строки без перевода строки
+    const bool unterminated = !content.empty() && content.back() != '\n';
+    std::replace(content.begin(), content.end(), '\n', ' ');
+    if (unterminated) {
+        content.push_back(' ');
+    }
 }
 
-// Получение поисковых запросов
-std::vector<std::string> ConverterJSON::GetRequests() const {
-    std::vector<std::string> requests;
+void ConverterJSON::logLoaded(size_t index, const std::string& content) const {
+    std::lock_guard<std::mutex> lock(logMutex);
+    std::cout << "Loaded document " << index << ": " << filePaths[index]
+             << " (" << content.length() << " chars)" << std::endl;
+}
 
+std::string ConverterJSON::ReadDocument(size_t index) const {
     try {
-        std::string requestsPath = findFile("requests.json");
-        std::ifstream requestsFile(requestsPath);
+        const std::string& fullPath = resolvedPaths[index];
+        if (fullPath.empty()) {
+            throw std::runtime_error("File not found: " + filePaths[index]);
+        }
+        std::string content;
 
-        if (!requestsFile.is_open()) {
-            std::cerr << "Warning: Cannot open requests file: " << requestsPath << std::endl;
-            return requests;
+        if (!readWholeFile(fullPath, content)) {
+            std::lock_guard<std::mutex> lock(logMutex);
+            std::cerr << "Warning: Cannot open file: " << filePaths[index] << std::endl;
+            return ""; // Пустой документ
         }
 
-        nlohmann::json requestsJson;
-        requestsFile >> requestsJson;
+        logLoaded(index, content);
+        return content;
 
-        if (requestsJson.contains("requests") && requestsJson["requests"].is_array()) {
-            for (const auto& request : requestsJson["requests"]) {
-                if (request.is_string() && !request.get<std::string>().empty()) {
-                    requests.push_back(request.get<std::string>());
-                }
-            }
-        }
+    } catch (const std::exception& e) {
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::cerr << "Error reading file " << filePaths[index] << ": " << e.what() << std::endl;
+        return ""; // Пустой документ
+    }
+}
 
-        std::cout << "Loaded " << requests.size() << " requests" << std::endl;
+void ConverterJSON::ReadDocuments(size_t begin, size_t end, std::vector<std::string>& texts) const {
+    if (io_backend != "io_uring") {
+        for (size_t i = begin; i < end; ++i) {
+            texts[i - begin] = ReadDocument(i);
+        }
+        return;
+    }
 
+    // Кольцо создается один раз на поток чтения и переиспользуется между пакетами
+    thread_local std::unique_ptr<UringReader> reader;
+    std::vector<std::string> paths;
+    std::vector<bool> loaded;
+    try {
+        if (!reader) {
+            reader = std::make_unique<UringReader>();
+        }
+        // Ненайденные файлы (пустой путь) кольцо отклонит, и они уйдут в ReadDocument
+        paths.assign(resolvedPaths.begin() + begin, resolvedPaths.begin() + end);
+        reader->ReadFiles(paths, texts, loaded);
     } catch (const std::exception& e) {
-        std::cerr << "Error reading requests: " << e.what() << std::endl;
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            std::cerr << "Warning: io_uring read failed (" << e.what()
+                      << "), falling back to synchronous reads" << std::endl;
+        }
+        reader.reset();
+        loaded.assign(end - begin, false);
+        texts.assign(end - begin, std::string());
     }
 
-    return requests;
+    // Файлы, которые не удалось прочитать через кольцо, читаются обычным путем:
+    // он же выводит предупреждение о недоступном файле
+    for (size_t i = begin; i < end; ++i) {
+        std::string& content = texts[i - begin];
+        if (!loaded[i - begin]) {
+            content = ReadDocument(i);
+            continue;
+        }
+        normalizeLineBreaks(content);
+        logLoaded(i, content);
+    }
 }
 
-// Сохранение результатов поиска
-void ConverterJSON::putAnswers(const std::vector<std::vector<RelativeIndex>>& answers) const {
-    nlohmann::json answersJson;
+const std::vector<std::string>& ConverterJSON::GetFilePaths() const {
+    return filePaths;
+}
 
-    for (size_t i = 0; i < answers.size(); ++i) {
-        std::string requestId = "request" + std::string(3 - std::to_string(i + 1).length(), '0') + std::to_string(i + 1);
+const std::vector<std::string>& ConverterJSON::GetResolvedPaths() const {
+    return resolvedPaths;
+}
 
-        if (answers[i].empty()) {
-            answersJson["answers"][requestId]["result"] = false;
-        } else {
-            answersJson["answers"][requestId]["result"] = true;
-
-            // Ограничиваем количество результатов согласно max_responses
-            size_t responseCount = std::min(answers[i].size(), max_responses);
-
-            if (responseCount == 1) {
-                // Если только один результат, сохраняем как объект
-                answersJson["answers"][requestId]["docid"] = answers[i][0].doc_id;
-                answersJson["answers"][requestId]["rank"] = answers[i][0].rank;
-            } else {
-                // Если несколько результатов, сохраняем как массив
-                for (size_t j = 0; j < responseCount; ++j) {
-                    nlohmann::json relevanceItem;
-                    relevanceItem["docid"] = answers[i][j].doc_id;
-                    relevanceItem["rank"] = answers[i][j].rank;
-                    answersJson["answers"][requestId]["relevance"].push_back(relevanceItem);
-                }
-            }
+double ConverterJSON::GetPathResolutionMs() const {
+    return pathResolutionMs;
+}
+
+// Получение поисковых запросов
+std::vector<std::string> ConverterJSON::GetRequests() const {
+    std::vector<std::string> requests;
+
+    try {
+        RequestSource source = OpenRequests();
+        std::string request;
+        while (source.Next(request)) {
+            requests.push_back(std::move(request));
         }
+
+        std::cout << "Loaded " << requests.size() << " requests" << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error reading requests: " << e.what() << std::endl;
     }
 
-    try {
-        // Создаем директорию JSON если её нет
-        std::filesystem::create_directories("JSON");
+    return requests;
+}
 
-        std::ofstream answersFile("JSON/answers.json");
-        if (!answersFile.is_open()) {
-            std::cerr << "Error: Cannot create answers file" << std::endl;
-            return;
-        }
+RequestSource ConverterJSON::OpenRequests() const {
+    return RequestSource(findFile(requests_file));
+}
 
-        answersFile << answersJson.dump(4);
-        std::cout << "Results saved to JSON/answers.json" << std::endl;
+// Сохранение результатов поиска
+void ConverterJSON::putAnswers(const std::vector<std::vector<RelativeIndex>>& answers) const {
+    try {
+        AnswersWriter writer = OpenAnswers();
+        writer.AddAll(answers);
+        writer.Finish();
+        std::cout << "Results saved to " << GetAnswersPath() << std::endl;
 
     } catch (const std::exception& e) {
         std::cerr << "Error saving answers: " << e.what() << std::endl;
     }
 }
 
+AnswersWriter ConverterJSON::OpenAnswers() const {
+    AnswersWriter::Format format = compact_answers ? AnswersWriter::Format::Compact
+                                                   : AnswersWriter::Format::Pretty;
+    if (answers_format == "cbor") {
+        format = AnswersWriter::Format::Cbor;
+    } else if (answers_format == "msgpack") {
+        format = AnswersWriter::Format::MessagePack;
+    }
+
+    // Создаем директорию JSON если её нет
+    std::filesystem::create_directories("JSON");
+    return AnswersWriter(GetAnswersPath(), format, max_responses, thread_pool_size);
+}
+
+std::string ConverterJSON::GetAnswersPath() const {
+    return "JSON/answers." + answers_format;
+}
+
 // Получение максимального количества ответов
 size_t ConverterJSON::GetResponsesLimit() const {
     return max_responses;
 }
 
+// Получение размера пула потоков (0 — по числу ядер)
+size_t ConverterJSON::GetThreadPoolSize() const {
+    return thread_pool_size;
+}
+
+// Хранить ли списки вхождений индекса в сжатом виде
+bool ConverterJSON::GetCompressPostings() const {
+    return compress_postings;
+}
+
+// Путь к сегменту индекса (пустая строка — сегмент не используется)
+std::string ConverterJSON::GetIndexSegmentPath() const {
+    return index_segment;
+}
+
+// Число потоков чтения документов (0 — по числу ядер)
+size_t ConverterJSON::GetLoaderThreads() const {
+    return loader_threads;
+}
+
+std::string ConverterJSON::GetIoBackend() const {
+    return io_backend;
+}
+
+// Бюджет памяти построения индекса в МБ (0 — без ограничения)
+size_t ConverterJSON::GetIndexMemoryBudgetMb() const {
+    return index_memory_budget_mb;
+}
+
 // Получение имени приложения
 std::string ConverterJSON::GetAppName() const {
     return appName;
@@ -302,41 +564,37 @@ void ConverterJSON::discoverFiles() {
             throw std::runtime_error("Resources path is not a directory: " + resourcesPath);
         }
 
-        // Получаем список всех файлов в папке
-        std::vector<std::string> allFiles;
-        for (const auto& entry : std::filesystem::directory_iterator(resourcesPath)) {
-            if (entry.is_regular_file()) {
-                std::string filename = entry.path().filename().string();
-                
-                // Проверяем расширение файла
-                bool supportedExtension = false;
-                std::vector<std::string> supportedExtensions = {".txt", ".md"};
-                for (const auto& ext : supportedExtensions) {
-                    if (filename.length() >= ext.length() && 
-                        filename.substr(filename.length() - ext.length()) == ext) {
-                        supportedExtension = true;
-                        break;
-                    }
-                }
-                
-                if (supportedExtension) {
-                    allFiles.push_back(resources_directory + "/" + filename);
-                }
-            }
-        }
-
-        // Сортируем файлы по имени для предсказуемого порядка
-        std::sort(allFiles.begin(), allFiles.end());
+        // Рекурсивный обход в loader_threads потоков; сортировка по пути
+        // делает порядок документов (и doc_id) независимым от порядка обхода
+        FileDiscovery::Options options;
+        options.extensions = supported_extensions;
+        options.maxFileSize = static_cast<uint64_t>(max_file_size_mb) * 1024 * 1024;
+        options.threads = loader_threads;
+        FileDiscovery discovery(options);
+        std::vector<std::string> allFiles = discovery.Discover(resourcesPath);
 
         // Ограничиваем количество файлов
         size_t filesToAdd = std::min(allFiles.size(), max_files_to_process);
         filePaths.reserve(filesToAdd);
+        resolvedPaths.reserve(filesToAdd);
 
+        // Полные пути известны из обхода, повторный поиск не нужен
+        const std::filesystem::path absoluteRoot =
+            std::filesystem::absolute(resourcesPath).lexically_normal();
         for (size_t i = 0; i < filesToAdd; ++i) {
-            filePaths.push_back(allFiles[i]);
+            resolvedPaths.push_back((absoluteRoot / allFiles[i]).string());
+            filePaths.push_back(resources_directory + "/" + allFiles[i]);
         }
 
-        std::cout << "Auto-discovered " << filePaths.size() << " files from " << resources_directory << std::endl;
+        std::cout << "Auto-discovered " << filePaths.size() << " files from " << resources_directory
+                  << " (" << discovery.DirectoryCount() << " directories)" << std::endl;
+        if (discovery.SkippedBySize() > 0) {
+            std::cout << "  (Skipped " << discovery.SkippedBySize() << " files larger than "
+                      << max_file_size_mb << " MB)" << std::endl;
+        }
+        if (discovery.SkippedDirectories() > 0) {
+            std::cout << "  (Skipped " << discovery.SkippedDirectories() << " unreadable directories)" << std::endl;
+        }
         if (allFiles.size() > max_files_to_process) {
             std::cout << "  (Limited to " << max_files_to_process << " files)" << std::endl;
         }
@@ -0,0 +1,32 @@
+#include "DocumentTerms.h"
+#include <algorithm>
+
+void DocumentTerms::Assign(std::string_view text, Tokenizer& tokenizer) {
+    bytes.clear();
+    terms.clear();
+    length = text.size();
+
+    // Сортировка списка слов прямо в буфере токенизатора: одинаковые слова оказываются рядом,
+    // а копия списка и выделение памяти на каждый документ не нужны
+    tokenizer.Tokenize(text);
+    std::vector<std::string_view>& words = tokenizer.MutableTokens();
+    tokenCount = words.size();
+    words.erase(std::remove_if(words.begin(), words.end(),
+                               [](std::string_view word) {
+                                   return word.length() > Tokenizer::kMaxWordLength;
+                               }),
+                words.end());
+    std::sort(words.begin(), words.end());
+
+    for (size_t i = 0; i < words.size();) {
+        size_t next = i + 1;
+        while (next < words.size() && words[next] == words[i]) {
+            ++next;
+        }
+        terms.push_back(Term{static_cast<uint32_t>(bytes.size()),
+                             static_cast<uint32_t>(words[i].size()),
+                             static_cast<uint32_t>(next - i)});
+        bytes.append(words[i]);
+        i = next;
+    }
+}
@@ -0,0 +1,176 @@
+#include "FileDiscovery.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+FileDiscovery::FileDiscovery(Options options) : options(std::move(options)) {
+    if (this->options.threads == 0) {
+        this->options.threads = std::max<unsigned>(1, std::thread::hardware_concurrency());
+    }
+}
+
+bool FileDiscovery::hasSupportedExtension(const char* name, size_t length) const {
+    if (options.extensions.empty()) {
+        return true;
+    }
+    for (const auto& ext : options.extensions) {
+        if (length >= ext.size() && std::memcmp(name + length - ext.size(), ext.data(), ext.size()) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FileDiscovery::Walk(const std::string& root, const Sink& sink) {
+    struct stat rootInfo;
+    if (::stat(root.c_str(), &rootInfo) != 0 || !S_ISDIR(rootInfo.st_mode)) {
+        throw std::runtime_error("Resources path is not a directory: " + root);
+    }
+
+    // Стек каталогов (пути относительно root, "" — сам root) и число каталогов
+    // в работе: обход закончен, когда стек пуст и никто не читает каталог
+    std::vector<std::string> pending{std::string()};
+    size_t active = 0;
+    bool failed = false;
+    std::exception_ptr failure;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::mutex sinkMutex;
+
+    std::atomic<size_t> directories{0};
+    std::atomic<size_t> skippedDirs{0};
+    std::atomic<size_t> skippedSize{0};
+
+    auto scan = [&](const std::string& relative, std::vector<std::string>& subdirs,
+                    std::vector<std::string>& files) {
+        const std::string path = relative.empty() ? root : root + "/" + relative;
+        DIR* dir = ::opendir(path.c_str());
+        if (!dir) {
+            skippedDirs++;
+            return;
+        }
+        directories++;
+        const int dirFd = ::dirfd(dir);
+        const std::string prefix = relative.empty() ? std::string() : relative + "/";
+
+        while (dirent* entry = ::readdir(dir)) {
+            const char* name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+            const size_t length = std::strlen(name);
+
+            unsigned char type = entry->d_type;
+            struct stat info;
+            bool haveInfo = false;
+            // Файловые системы без d_type и символические ссылки требуют stat
+            if (type == DT_UNKNOWN || type == DT_LNK) {
+                if (::fstatat(dirFd, name, &info, 0) != 0) {
+                    continue;
+                }
+                haveInfo = true;
+                type = S_ISDIR(info.st_mode) ? DT_DIR : S_ISREG(info.st_mode) ? DT_REG : DT_UNKNOWN;
+            }
+
+            if (type == DT_DIR) {
+                // Ссылки на каталоги не обходятся, чтобы не зациклиться
+                if (entry->d_type != DT_LNK) {
+                    subdirs.push_back(prefix + name);
+                }
+                continue;
+            }
+            if (type != DT_REG || !hasSupportedExtension(name, length)) {
+                continue;
+            }
+            if (options.maxFileSize > 0) {
+                if (!haveInfo && ::fstatat(dirFd, name, &info, 0) != 0) {
+                    continue;
+                }
+                if (static_cast<uint64_t>(info.st_size) > options.maxFileSize) {
+                    skippedSize++;
+                    continue;
+                }
+            }
+            files.push_back(prefix + name);
+        }
+        ::closedir(dir);
+    };
+
+    auto worker = [&]() {
+        std::vector<std::string> subdirs;
+        std::vector<std::string> files;
+        while (true) {
+            std::string relative;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return failed || !pending.empty() || active == 0; });
+                if (failed || pending.empty()) {
+                    return;
+                }
+                relative = std::move(pending.back());
+                pending.pop_back();
+                ++active;
+            }
+
+            subdirs.clear();
+            files.clear();
+            try {
+                scan(relative, subdirs, files);
+                if (!files.empty()) {
+                    std::lock_guard<std::mutex> lock(sinkMutex);
+                    sink(files);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!failed) {
+                    failed = true;
+                    failure = std::current_exception();
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (auto& subdir : subdirs) {
+                    pending.push_back(std::move(subdir));
+                }
+                --active;
+            }
+            wake.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < options.threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    directoryCount = directories;
+    skippedDirectories = skippedDirs;
+    skippedBySize = skippedSize;
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+std::vector<std::string> FileDiscovery::Discover(const std::string& root) {
+    std::vector<std::string> paths;
+    Walk(root, [&paths](std::vector<std::string>& batch) {
+        paths.insert(paths.end(), std::make_move_iterator(batch.begin()),
+                     std::make_move_iterator(batch.end()));
+    });
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
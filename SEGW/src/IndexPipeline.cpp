@@ -0,0 +1,243 @@
+#include "IndexPipeline.h"
+#include "BoundedQueue.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct RawDocument {
+    size_t docId = 0;
+    std::string text;
+};
+
+struct TokenizedDocument {
+    size_t docId = 0;
+    DocumentTerms terms;
+};
+
+} // namespace
+
+IndexPipeline::IndexPipeline(size_t tokenizerThreads, size_t queueCapacity, size_t readerThreads)
+    : tokenizerThreads(tokenizerThreads),
+      queueCapacity(std::max<size_t>(1, queueCapacity)),
+      readerThreads(readerThreads) {
+    const size_t cores = std::max<unsigned>(1, std::thread::hardware_concurrency());
+    if (this->tokenizerThreads == 0) {
+        this->tokenizerThreads = cores;
+    }
+    if (this->readerThreads == 0) {
+        this->readerThreads = cores;
+    }
+}
+
+size_t IndexPipeline::WindowSize(size_t batchSize) const {
+    // Пакет целиком должен помещаться в окно, иначе читатель первого
+    // непостроенного документа ждал бы сам себя
+    return std::max(2 * queueCapacity, std::max<size_t>(1, batchSize));
+}
+
+void IndexPipeline::Run(size_t documentCount, const Reader& read, const Sink& sink) {
+    RunBatched(documentCount,
+               [&read](size_t begin, size_t, std::vector<std::string>& texts) {
+                   texts[0] = read(begin);
+               },
+               sink, 1);
+}
+
+void IndexPipeline::RunBatched(size_t documentCount, const BatchReader& read, const Sink& sink,
+                               size_t batchSize) {
+    RunSharded(documentCount, read,
+               [&sink](size_t, size_t docId, DocumentTerms& terms) {
+                   sink(docId, terms);
+               },
+               batchSize, 1);
+}
+
+void IndexPipeline::RunSharded(size_t documentCount, const BatchReader& read, const ShardSink& sink,
+                               size_t batchSize, size_t shardCount) {
+    batchSize = std::max<size_t>(1, batchSize);
+    shardCount = std::max<size_t>(1, shardCount);
+    BoundedQueue<RawDocument> rawQueue(queueCapacity);
+    BoundedQueue<TokenizedDocument> tokenizedQueue(queueCapacity);
+    std::vector<std::unique_ptr<BoundedQueue<TokenizedDocument>>> shardQueues;
+    if (shardCount > 1) {
+        for (size_t shard = 0; shard < shardCount; ++shard) {
+            shardQueues.push_back(std::make_unique<BoundedQueue<TokenizedDocument>>(queueCapacity));
+        }
+    }
+    auto closeShards = [&shardQueues]() {
+        for (auto& queue : shardQueues) {
+            queue->Close();
+        }
+    };
+
+    // Окно doc_id: читатель не берет документы дальше indexed + window, пока стадия
+    // построения не продвинется. Так буфер переупорядочивания не растет, даже если
+    // один документ обрабатывается намного дольше остальных
+    const size_t window = WindowSize(batchSize);
+    std::mutex windowMutex;
+    std::condition_variable windowCondition;
+    size_t indexed = 0;
+    bool stopped = false;
+    auto stop = [&]() {
+        {
+            std::lock_guard<std::mutex> lock(windowMutex);
+            stopped = true;
+        }
+        windowCondition.notify_all();
+    };
+
+    std::exception_ptr failure;
+    std::mutex failureMutex;
+    auto fail = [&]() {
+        {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+        stop();
+        rawQueue.Close();
+        tokenizedQueue.Close();
+        closeShards();
+    };
+
+    // Читатели разбирают пакеты doc_id по счетчику; последний закрывает очередь
+    std::atomic<size_t> nextToRead{0};
+    std::atomic<size_t> activeReaders{readerThreads};
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < readerThreads; ++i) {
+        readers.emplace_back([&]() {
+            try {
+                std::vector<std::string> texts;
+                bool open = true;
+                while (open) {
+                    const size_t begin = nextToRead.fetch_add(batchSize);
+                    if (begin >= documentCount) {
+                        break;
+                    }
+                    const size_t end = std::min(documentCount, begin + batchSize);
+                    {
+                        std::unique_lock<std::mutex> lock(windowMutex);
+                        windowCondition.wait(lock, [&]() { return end <= indexed + window || stopped; });
+                        if (stopped) {
+                            break;
+                        }
+                    }
+                    texts.assign(end - begin, std::string());
+                    read(begin, end, texts);
+                    for (size_t docId = begin; docId < end && open; ++docId) {
+                        open = rawQueue.Push(RawDocument{docId, std::move(texts[docId - begin])});
+                    }
+                }
+            } catch (...) {
+                fail();
+            }
+            if (activeReaders.fetch_sub(1) == 1) {
+                rawQueue.Close();
+            }
+        });
+    }
+
+    // Последний завершившийся токенизатор закрывает выходную очередь
+    std::atomic<size_t> activeTokenizers{tokenizerThreads};
+    std::vector<std::thread> tokenizers;
+    for (size_t i = 0; i < tokenizerThreads; ++i) {
+        tokenizers.emplace_back([&]() {
+            try {
+                Tokenizer tokenizer;
+                RawDocument raw;
+                while (rawQueue.Pop(raw)) {
+                    TokenizedDocument tokenized;
+                    tokenized.docId = raw.docId;
+                    tokenized.terms.Assign(raw.text, tokenizer);
+                    std::string().swap(raw.text);
+                    if (!tokenizedQueue.Push(std::move(tokenized))) {
+                        break;
+                    }
+                }
+            } catch (...) {
+                fail();
+            }
+            if (activeTokenizers.fetch_sub(1) == 1) {
+                tokenizedQueue.Close();
+            }
+        });
+    }
+
+    // Потоки шардов получают документы из своих очередей уже по порядку
+    std::vector<std::thread> builders;
+    for (size_t shard = 0; shard < shardQueues.size(); ++shard) {
+        builders.emplace_back([&, shard]() {
+            try {
+                TokenizedDocument tokenized;
+                while (shardQueues[shard]->Pop(tokenized)) {
+                    sink(shard, tokenized.docId, tokenized.terms);
+                }
+            } catch (...) {
+                fail();
+            }
+        });
+    }
+
+    // Документ в построение: сразу в sink или в очередь своего шарда.
+    // false — конвейер остановлен ошибкой
+    auto build = [&](size_t docId, DocumentTerms& terms) {
+        if (shardQueues.empty()) {
+            sink(0, docId, terms);
+            return true;
+        }
+        return shardQueues[docId % shardCount]->Push(TokenizedDocument{docId, std::move(terms)});
+    };
+
+    // Токенизаторы завершают документы в произвольном порядке:
+    // опередившие документы ждут своей очереди в буфере
+    try {
+        std::map<size_t, DocumentTerms> pending;
+        size_t nextDocId = 0;
+        TokenizedDocument tokenized;
+        bool open = true;
+        while (open && tokenizedQueue.Pop(tokenized)) {
+            if (tokenized.docId != nextDocId) {
+                pending.emplace(tokenized.docId, std::move(tokenized.terms));
+                continue;
+            }
+            open = build(nextDocId++, tokenized.terms);
+            for (auto it = pending.begin(); open && it != pending.end() && it->first == nextDocId;
+                 it = pending.erase(it)) {
+                open = build(nextDocId++, it->second);
+            }
+
+            // Окно сдвигается: ожидающие читатели могут брать следующие документы
+            {
+                std::lock_guard<std::mutex> lock(windowMutex);
+                indexed = nextDocId;
+            }
+            windowCondition.notify_all();
+        }
+    } catch (...) {
+        fail();
+    }
+    stop();
+    closeShards();
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    for (auto& tokenizer : tokenizers) {
+        tokenizer.join();
+    }
+    for (auto& builder : builders) {
+        builder.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
@@ -0,0 +1,475 @@
+#include "IndexSegment.h"
+#include "TermDictionary.h"
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(Entry) == 2 * sizeof(uint64_t), "Entry layout must match the segment format");
+
+namespace {
+
+const char kMagic[8] = {'S', 'E', 'G', 'W', 'I', 'D', 'X', '\0'};
+
+constexpr uint64_t kFnvOffset = 0xcbf29ce484222325ULL;
+constexpr uint64_t kFnvPrime = 0x100000001b3ULL;
+
+uint64_t fnv1a(uint64_t hash, const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+// Та же заполненность, что и у TermDictionary — не более 7/10
+size_t slotCountFor(size_t termCount) {
+    size_t slotCount = 16;
+    while ((termCount + 1) * 10 > slotCount * 7) {
+        slotCount *= 2;
+    }
+    return slotCount;
+}
+
+// offsets[0..count]: начинаются с нуля, не убывают, шаг кратен step, последнее равно total
+bool offsetsValid(const uint64_t* offsets, size_t count, uint64_t total, uint64_t step) {
+    if (offsets[0] != 0 || offsets[count] != total) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (offsets[i + 1] < offsets[i] || (offsets[i + 1] - offsets[i]) % step != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// ---- SegmentWriter ----
+
+SegmentWriter::SegmentWriter(const std::string& path, bool compressed)
+    : path(path), compressed(compressed), checksum(kFnvOffset),
+      documentsPath(path + ".docs"), sourcesPath(path + ".sources") {
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Cannot create index segment: " + path);
+    }
+    documentsFile = std::fopen(documentsPath.c_str(), "w+b");
+    sourcesFile = std::fopen(sourcesPath.c_str(), "w+b");
+
+    // Место под заголовок; сам заголовок записывается в Finish
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.flags = compressed ? kCompressed : 0;
+    if (!documentsFile || !sourcesFile || std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        discard(); // деструктор для недостроенного объекта не вызывается
+        throw std::runtime_error("Cannot create index segment: " + path);
+    }
+    position = sizeof(header);
+    header.postingsOffset = position;
+}
+
+SegmentWriter::~SegmentWriter() {
+    discard();
+}
+
+// Закрывает файлы и удаляет временные; незавершенный сегмент тоже не оставляем
+void SegmentWriter::discard() {
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+        if (!finished) {
+            std::remove(path.c_str());
+        }
+    }
+    if (documentsFile) {
+        std::fclose(documentsFile);
+        documentsFile = nullptr;
+    }
+    if (sourcesFile) {
+        std::fclose(sourcesFile);
+        sourcesFile = nullptr;
+    }
+    std::remove(documentsPath.c_str());
+    std::remove(sourcesPath.c_str());
+}
+
+void SegmentWriter::write(const void* data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    if (std::fwrite(data, 1, size, file) != size) {
+        throw std::runtime_error("Cannot write index segment: " + path);
+    }
+    checksum = fnv1a(checksum, static_cast<const uint8_t*>(data), size);
+    position += size;
+}
+
+void SegmentWriter::align() {
+    static const uint8_t zeros[8] = {};
+    write(zeros, (8 - position % 8) % 8);
+}
+
+void SegmentWriter::addTermBytes(std::string_view term) {
+    termBytes.append(term.data(), term.size());
+    termOffsets.push_back(termBytes.size());
+    termHashes.push_back(TermDictionary::Hash(term));
+}
+
+void SegmentWriter::AddTerm(std::string_view term, const std::vector<Entry>& entries) {
+    BeginTerm(term, entries.size());
+    AppendPostings(PostingsView(entries.data(), entries.size()));
+    EndTerm();
+}
+
+void SegmentWriter::BeginTerm(std::string_view term, size_t postingCount) {
+    addTermBytes(term);
+    termPostings = postingCount;
+    if (compressed) {
+        encodeBuffer.clear();
+        encoder.Begin(postingCount, encodeBuffer);
+        write(encodeBuffer.data(), encodeBuffer.size());
+    }
+}
+
+void SegmentWriter::AppendPostings(PostingsView entries) {
+    if (entries.size() > termPostings) {
+        throw std::logic_error("More postings than declared for the term");
+    }
+    termPostings -= entries.size();
+
+    if (!compressed) {
+        write(entries.begin(), entries.size() * sizeof(Entry));
+        return;
+    }
+    encodeBuffer.clear();
+    encoder.Add(entries, encodeBuffer);
+    write(encodeBuffer.data(), encodeBuffer.size());
+}
+
+void SegmentWriter::EndTerm() {
+    if (termPostings != 0) {
+        throw std::logic_error("Fewer postings than declared for the term");
+    }
+    if (compressed) {
+        encodeBuffer.clear();
+        encoder.End(encodeBuffer);
+        write(encodeBuffer.data(), encodeBuffer.size());
+    }
+    postingOffsets.push_back(position - header.postingsOffset);
+}
+
+void SegmentWriter::AddEncodedTerm(std::string_view term, const uint8_t* data, size_t size) {
+    if (!compressed) {
+        throw std::logic_error("Encoded postings require a compressed segment");
+    }
+    write(data, size);
+    postingOffsets.push_back(position - header.postingsOffset);
+    addTermBytes(term);
+}
+
+void SegmentWriter::AddDocument(uint64_t length, uint64_t tokenCount, std::string_view source,
+                                bool removed) {
+    sourceBytesSize += source.size();
+    const SegmentDocument document{length, tokenCount, removed ? kRemovedDocument : 0};
+    if (std::fwrite(&document, sizeof(document), 1, documentsFile) != 1 ||
+        std::fwrite(&sourceBytesSize, sizeof(sourceBytesSize), 1, documentsFile) != 1 ||
+        std::fwrite(source.data(), 1, source.size(), sourcesFile) != source.size()) {
+        throw std::runtime_error("Cannot write index segment: " + documentsPath);
+    }
+    header.removedCount += removed ? 1 : 0;
+    ++documentCount;
+}
+
+// Копирует из временного файла поле [offset, offset + size) каждой записи размером recordSize
+void SegmentWriter::copySpill(std::FILE* spill, const std::string& spillPath, size_t recordSize,
+                              size_t offset, size_t size) {
+    if (std::fflush(spill) != 0 || std::fseek(spill, 0, SEEK_SET) != 0) {
+        throw std::runtime_error("Cannot read index segment: " + spillPath);
+    }
+
+    std::vector<uint8_t> buffer(recordSize * 4096);
+    std::vector<uint8_t> fields;
+    while (true) {
+        const size_t records = std::fread(buffer.data(), recordSize, buffer.size() / recordSize, spill);
+        if (records == 0) {
+            break;
+        }
+        if (offset == 0 && size == recordSize) {
+            write(buffer.data(), records * recordSize);
+            continue;
+        }
+        fields.resize(records * size);
+        for (size_t i = 0; i < records; ++i) {
+            std::memcpy(fields.data() + i * size, buffer.data() + i * recordSize + offset, size);
+        }
+        write(fields.data(), fields.size());
+    }
+    if (std::ferror(spill)) {
+        throw std::runtime_error("Cannot read index segment: " + spillPath);
+    }
+}
+
+void SegmentWriter::Finish() {
+    const size_t termCount = termHashes.size();
+
+    header.postingsSize = position - header.postingsOffset;
+    align();
+
+    header.postingOffsetsOffset = position;
+    write(postingOffsets.data(), postingOffsets.size() * sizeof(uint64_t));
+
+    header.termOffsetsOffset = position;
+    write(termOffsets.data(), termOffsets.size() * sizeof(uint64_t));
+
+    header.termBytesOffset = position;
+    header.termBytesSize = termBytes.size();
+    write(termBytes.data(), termBytes.size());
+    align();
+
+    // Хеш-таблица строится по уже вычисленным хешам
+    header.slotCount = slotCountFor(termCount);
+    std::vector<SegmentSlot> slots(header.slotCount, SegmentSlot{0, IndexSegment::kNoTerm});
+    const size_t mask = header.slotCount - 1;
+    for (uint32_t termId = 0; termId < termCount; ++termId) {
+        size_t pos = termHashes[termId] & mask;
+        while (slots[pos].term_id != IndexSegment::kNoTerm) {
+            pos = (pos + 1) & mask;
+        }
+        slots[pos] = SegmentSlot{termHashes[termId], termId};
+    }
+    header.slotsOffset = position;
+    write(slots.data(), slots.size() * sizeof(SegmentSlot));
+
+    // Метаданные документов копируются из временных файлов
+    constexpr size_t kRecordSize = sizeof(SegmentDocument) + sizeof(uint64_t);
+    header.documentsOffset = position;
+    copySpill(documentsFile, documentsPath, kRecordSize, 0, sizeof(SegmentDocument));
+
+    header.sourceOffsetsOffset = position;
+    const uint64_t firstSourceOffset = 0;
+    write(&firstSourceOffset, sizeof(firstSourceOffset));
+    copySpill(documentsFile, documentsPath, kRecordSize, sizeof(SegmentDocument), sizeof(uint64_t));
+
+    header.sourceBytesOffset = position;
+    header.sourceBytesSize = sourceBytesSize;
+    copySpill(sourcesFile, sourcesPath, 1, 0, 1);
+    align();
+
+    header.documentCount = documentCount;
+    header.termCount = termCount;
+    header.fileSize = position;
+    header.checksum = checksum;
+
+    if (std::fseek(file, 0, SEEK_SET) != 0 ||
+        std::fwrite(&header, sizeof(header), 1, file) != 1 ||
+        std::fflush(file) != 0) {
+        throw std::runtime_error("Cannot write index segment: " + path);
+    }
+
+    std::fclose(file);
+    file = nullptr;
+    finished = true;
+    discard();
+}
+
+// ---- IndexSegment ----
+
+std::unique_ptr<IndexSegment> IndexSegment::Open(const std::string& path, bool verify) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open index segment: " + path);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SegmentHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Invalid index segment: " + path);
+    }
+
+    const size_t size = static_cast<size_t>(info.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Cannot map index segment: " + path);
+    }
+
+    std::unique_ptr<IndexSegment> segment(new IndexSegment());
+    segment->base = static_cast<const uint8_t*>(mapped);
+    segment->mappedSize = size;
+
+    const SegmentHeader* header = reinterpret_cast<const SegmentHeader*>(segment->base);
+    segment->header = header;
+
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not an index segment: " + path);
+    }
+    if (header->version != SegmentWriter::kVersion) {
+        throw std::runtime_error("Unsupported index segment version " +
+                                 std::to_string(header->version) + ": " + path);
+    }
+    if (header->fileSize != size) {
+        throw std::runtime_error("Truncated index segment: " + path);
+    }
+
+    // Проверка границ секций до любых обращений к ним
+    auto sectionFits = [size](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset % 8 == 0 && offset <= size && count <= (size - offset) / elementSize;
+    };
+    if (header->termCount >= size || header->termCount >= kNoTerm || header->documentCount >= size ||
+        (header->slotCount & (header->slotCount - 1)) != 0 ||
+        !sectionFits(header->postingsOffset, header->postingsSize, 1) ||
+        !sectionFits(header->postingOffsetsOffset, header->termCount + 1, sizeof(uint64_t)) ||
+        !sectionFits(header->termOffsetsOffset, header->termCount + 1, sizeof(uint64_t)) ||
+        !sectionFits(header->termBytesOffset, header->termBytesSize, 1) ||
+        !sectionFits(header->slotsOffset, header->slotCount, sizeof(SegmentSlot)) ||
+        !sectionFits(header->documentsOffset, header->documentCount, sizeof(SegmentDocument)) ||
+        !sectionFits(header->sourceOffsetsOffset, header->documentCount + 1, sizeof(uint64_t)) ||
+        !sectionFits(header->sourceBytesOffset, header->sourceBytesSize, 1)) {
+        throw std::runtime_error("Corrupted index segment layout: " + path);
+    }
+
+    segment->postings = segment->base + header->postingsOffset;
+    segment->postingOffsets = reinterpret_cast<const uint64_t*>(segment->base + header->postingOffsetsOffset);
+    segment->termOffsets = reinterpret_cast<const uint64_t*>(segment->base + header->termOffsetsOffset);
+    segment->termBytes = reinterpret_cast<const char*>(segment->base + header->termBytesOffset);
+    segment->slots = reinterpret_cast<const SegmentSlot*>(segment->base + header->slotsOffset);
+    segment->documents = reinterpret_cast<const SegmentDocument*>(segment->base + header->documentsOffset);
+    segment->sourceOffsets = reinterpret_cast<const uint64_t*>(segment->base + header->sourceOffsetsOffset);
+    segment->sourceBytes = reinterpret_cast<const char*>(segment->base + header->sourceBytesOffset);
+
+    if (!segment->layoutValid()) {
+        throw std::runtime_error("Corrupted index segment layout: " + path);
+    }
+    if (verify && !segment->VerifyChecksum()) {
+        throw std::runtime_error("Index segment checksum mismatch: " + path);
+    }
+    if (verify && !segment->postingsValid()) {
+        throw std::runtime_error("Corrupted index segment postings: " + path);
+    }
+
+    return segment;
+}
+
+IndexSegment::~IndexSegment() {
+    if (base) {
+        ::munmap(const_cast<uint8_t*>(base), mappedSize);
+    }
+}
+
+// Всё, на что опираются Term, DocumentSource, FindTerm и курсоры, лежит внутри своих секций
+bool IndexSegment::layoutValid() const {
+    const uint64_t entryStep = IsCompressed() ? 1 : sizeof(Entry);
+    if (!offsetsValid(postingOffsets, header->termCount, header->postingsSize, entryStep) ||
+        !offsetsValid(termOffsets, header->termCount, header->termBytesSize, 1) ||
+        !offsetsValid(sourceOffsets, header->documentCount, header->sourceBytesSize, 1)) {
+        return false;
+    }
+
+    size_t removed = 0;
+    for (size_t docId = 0; docId < header->documentCount; ++docId) {
+        removed += IsRemoved(docId) ? 1 : 0;
+    }
+    if (removed != header->removedCount) {
+        return false;
+    }
+
+    // В таблице должен быть хотя бы один пустой слот, иначе поиск отсутствующего слова не остановится
+    size_t emptySlots = 0;
+    for (size_t pos = 0; pos < header->slotCount; ++pos) {
+        if (slots[pos].term_id == kNoTerm) {
+            ++emptySlots;
+        } else if (slots[pos].term_id >= header->termCount) {
+            return false;
+        }
+    }
+    return header->slotCount == 0 ? header->termCount == 0 : emptySlots > 0;
+}
+
+// doc_id каждого списка строго возрастают и указывают на существующие неудаленные документы
+bool IndexSegment::postingsValid() const {
+    try {
+        for (uint32_t termId = 0; termId < header->termCount; ++termId) {
+            bool first = true;
+            size_t lastDocId = 0;
+            for (PostingCursor cursor = Cursor(termId); cursor.Next(); ) {
+                for (const Entry& entry : cursor.Block()) {
+                    if (entry.doc_id >= header->documentCount || (!first && entry.doc_id <= lastDocId) ||
+                        entry.count == 0 || IsRemoved(entry.doc_id)) {
+                        return false;
+                    }
+                    first = false;
+                    lastDocId = entry.doc_id;
+                }
+            }
+        }
+    } catch (const std::runtime_error&) {
+        return false; // оборванный сжатый список
+    }
+    return true;
+}
+
+bool IndexSegment::VerifyChecksum() const {
+    const uint64_t actual = fnv1a(kFnvOffset, base + sizeof(SegmentHeader),
+                                  mappedSize - sizeof(SegmentHeader));
+    return actual == header->checksum;
+}
+
+std::string_view IndexSegment::Term(uint32_t termId) const {
+    return std::string_view(termBytes + termOffsets[termId],
+                            termOffsets[termId + 1] - termOffsets[termId]);
+}
+
+std::string_view IndexSegment::DocumentSource(size_t docId) const {
+    return std::string_view(sourceBytes + sourceOffsets[docId],
+                            sourceOffsets[docId + 1] - sourceOffsets[docId]);
+}
+
+uint32_t IndexSegment::FindTerm(std::string_view term) const {
+    if (header->slotCount == 0) {
+        return kNoTerm;
+    }
+
+    const uint32_t hash = TermDictionary::Hash(term);
+    const size_t mask = header->slotCount - 1;
+
+    size_t pos = hash & mask;
+    for (size_t probe = 0; probe < header->slotCount; ++probe, pos = (pos + 1) & mask) {
+        const SegmentSlot& slot = slots[pos];
+        if (slot.term_id == kNoTerm) {
+            return kNoTerm;
+        }
+        if (slot.hash == hash && Term(slot.term_id) == term) {
+            return slot.term_id;
+        }
+    }
+    return kNoTerm;
+}
+
+PostingsView IndexSegment::Postings(uint32_t termId) const {
+    if (IsCompressed()) {
+        throw std::logic_error("Segment postings are compressed, use Cursor");
+    }
+    const uint64_t begin = postingOffsets[termId];
+    const uint64_t end = postingOffsets[termId + 1];
+    return PostingsView(reinterpret_cast<const Entry*>(postings + begin),
+                        (end - begin) / sizeof(Entry));
+}
+
+PostingCursor IndexSegment::Cursor(uint32_t termId) const {
+    if (IsCompressed()) {
+        return PostingCursor(postings + postingOffsets[termId], postings + postingOffsets[termId + 1]);
+    }
+    return PostingCursor(Postings(termId));
+}
+
+size_t IndexSegment::PostingCount(uint32_t termId) const {
+    if (IsCompressed()) {
+        return CompressedPostings::EncodedCount(postings + postingOffsets[termId],
+                                                postings + postingOffsets[termId + 1]);
+    }
+    return Postings(termId).size();
+}
@@ -1,60 +1,497 @@
 #include "InvertedIndex.h"
-#include <sstream>
-#include <unordered_map>
 #include <algorithm>
-#include <cctype>
+#include <iterator>
+#include <future>
+#include <thread>
+#include <stdexcept>
 
 using namespace std;
 
-void InvertedIndex::UpdateDocumentBase(const vector<string>& input_docs) {
-    docs_ = input_docs;
-    freq_dictionary_.clear();
-
-    for (size_t doc_id = 0; doc_id < docs_.size(); ++doc_id) {
-        unordered_map<string, size_t> word_counts;
-
-        istringstream iss(docs_[doc_id]);
-        string word;
-        while (iss >> word) {
-            // Нормализация слова
-            string normalized_word;
-            for (char c : word) {
-                if (isalpha(static_cast<unsigned char>(c))) {
-                    normalized_word += tolower(static_cast<unsigned char>(c));
-                }
-            }
-            
-            if (!normalized_word.empty() && normalized_word.length() <= 100) {
-                ++word_counts[normalized_word];
-            }
+void InvertedIndex::UpdateDocumentBase(vector<string>&& input_docs, const vector<string>& sources) {
+    vector<string> docs = std::move(input_docs);
+    buildDocumentBase(docs, sources, &docs);
+}
+
+void InvertedIndex::UpdateDocumentBase(const vector<string>& input_docs, const vector<string>& sources) {
+    buildDocumentBase(input_docs, sources, nullptr);
+}
+
+void InvertedIndex::clearDocumentBase(size_t doc_count) {
+    freq_dictionary_.Clear();
+    build_shards_.clear();
+    compressed_.Clear();
+    segment_.reset();
+    removed_.clear();
+    removed_count_ = 0;
+    documents_.assign(doc_count, DocumentInfo());
+}
+
+void InvertedIndex::buildDocumentBase(const vector<string>& input_docs, const vector<string>& sources,
+                                      vector<string>* owned) {
+    clearDocumentBase(input_docs.size());
+    for (size_t doc_id = 0; doc_id < sources.size() && doc_id < documents_.size(); ++doc_id) {
+        documents_[doc_id].source = sources[doc_id];
+    }
+
+    const size_t shard_count = resolveThreadCount(input_docs.size());
+
+    if (shard_count <= 1) {
+        indexRange(input_docs, 0, input_docs.size(), freq_dictionary_, documents_, owned);
+        compressPostings();
+        return;
+    }
+
+    // Каждый поток индексирует свой непрерывный диапазон документов
+    vector<PostingStore> shards(shard_count);
+    vector<future<void>> futures;
+    futures.reserve(shard_count);
+
+    // Метаданные каждый поток записывает только в свой диапазон doc_id
+    const size_t chunk = (input_docs.size() + shard_count - 1) / shard_count;
+    for (size_t shard = 0; shard < shard_count; ++shard) {
+        const size_t begin = min(shard * chunk, input_docs.size());
+        const size_t end = min(begin + chunk, input_docs.size());
+        futures.emplace_back(async(launch::async, [this, &input_docs, &shards, owned, shard, begin, end]() {
+            indexRange(input_docs, begin, end, shards[shard], documents_, owned);
+        }));
+    }
+    for (auto& f : futures) {
+        f.get();
+    }
+
+    mergeShards(shards);
+    freq_dictionary_ = std::move(shards[0]);
+    compressPostings();
+}
+
+// Шард с меньшими doc_id всегда остается слева, поэтому для непрерывных
+// диапазонов списки просто дописываются и сохраняют порядок doc_id
+void InvertedIndex::mergeShards(vector<PostingStore>& shards) {
+    vector<future<void>> futures;
+    for (size_t step = 1; step < shards.size(); step *= 2) {
+        futures.clear();
+        for (size_t left = 0; left + step < shards.size(); left += 2 * step) {
+            futures.emplace_back(async(launch::async, [&shards, left, step]() {
+                mergeInto(shards[left], shards[left + step]);
+            }));
+        }
+        for (auto& f : futures) {
+            f.get();
         }
+    }
+}
+
+// Перевод списков вхождений в сжатое представление
+void InvertedIndex::compressPostings() {
+    if (!compress_postings_) {
+        return;
+    }
+
+    for (auto& entries : freq_dictionary_.postings) {
+        compressed_.Append(entries);
+        vector<Entry>().swap(entries); // освобождаем память сразу
+    }
+    freq_dictionary_.postings.clear();
+    freq_dictionary_.postings.shrink_to_fit();
+}
 
-        for (const auto& [word, count] : word_counts) {
-            freq_dictionary_[word].push_back({doc_id, count});
+// Подсчет нормализованных слов документа: каждое слово сразу интернируется,
+// поэтому строки не копируются, а счетчики ведутся по term_id
+size_t InvertedIndex::countWords(string_view text, Tokenizer& tokenizer,
+                                 TermDictionary& terms, TermCounts& term_counts) {
+    const auto& words = tokenizer.Tokenize(text);
+    for (string_view word : words) {
+        if (word.length() > Tokenizer::kMaxWordLength) {
+            continue;
+        }
+        const uint32_t term_id = terms.Intern(word);
+        if (term_id >= term_counts.counts.size()) {
+            term_counts.counts.resize(max<size_t>(term_id + 1, term_counts.counts.size() * 2), 0);
+        }
+        if (term_counts.counts[term_id]++ == 0) {
+            term_counts.touched.push_back(term_id);
         }
     }
+    return words.size();
+}
+
+void InvertedIndex::appendCounts(size_t doc_id, TermCounts& term_counts, PostingStore& out) {
+    if (out.postings.size() < out.terms.Size()) {
+        out.postings.resize(out.terms.Size());
+    }
+    for (uint32_t term_id : term_counts.touched) {
+        out.postings[term_id].push_back({doc_id, term_counts.counts[term_id]});
+        term_counts.counts[term_id] = 0;
+    }
+    term_counts.touched.clear();
+}
+
+// Индексация документов [begin, end) в частичный словарь
+void InvertedIndex::indexRange(const vector<string>& docs, size_t begin, size_t end,
+                               PostingStore& out, vector<DocumentInfo>& infos, vector<string>* owned) {
+    Tokenizer tokenizer;
+    TermCounts term_counts;
+
+    for (size_t doc_id = begin; doc_id < end; ++doc_id) {
+        infos[doc_id].length = docs[doc_id].size();
+        infos[doc_id].tokenCount = countWords(docs[doc_id], tokenizer, out.terms, term_counts);
+        appendCounts(doc_id, term_counts, out);
+        if (owned) {
+            // Текст больше не нужен: вхождения посчитаны, слова скопированы в словарь
+            string().swap((*owned)[doc_id]);
+        }
+    }
+}
+
+// Слияние словаря src в dst. Если документы src идут после документов dst,
+// списки дописываются; чередующиеся doc_id (шарды RunSharded) сливаются по порядку
+void InvertedIndex::mergeInto(PostingStore& dst, PostingStore& src) {
+    dst.terms.Reserve(dst.terms.Size() + src.terms.Size());
+
+    for (uint32_t src_id = 0; src_id < src.terms.Size(); ++src_id) {
+        const uint32_t dst_id = dst.terms.Intern(src.terms.Term(src_id));
+        auto& entries = src.postings[src_id];
+
+        if (dst_id == dst.postings.size()) {
+            // Новое для dst слово: список переносится без копирования
+            dst.postings.push_back(std::move(entries));
+        } else {
+            auto& target = dst.postings[dst_id];
+            const size_t middle = target.size();
+            target.insert(target.end(),
+                          make_move_iterator(entries.begin()),
+                          make_move_iterator(entries.end()));
+            if (middle > 0 && middle < target.size() && target[middle].doc_id < target[middle - 1].doc_id) {
+                inplace_merge(target.begin(), target.begin() + middle, target.end(),
+                              [](const Entry& a, const Entry& b) { return a.doc_id < b.doc_id; });
+            }
+        }
+    }
+    src.Clear();
+}
+
+size_t InvertedIndex::resolveThreadCount(size_t doc_count) const {
+    size_t threads = thread_count_;
+    if (threads == 0) {
+        threads = max<size_t>(1, thread::hardware_concurrency());
+    }
+    return min(threads, doc_count);
 }
 
 vector<Entry> InvertedIndex::GetWordCount(const string& word) const {
-    if (auto it = freq_dictionary_.find(word); it != freq_dictionary_.end()) {
-        return it->second;
+    vector<Entry> result;
+    for (PostingCursor cursor = GetCursor(word); cursor.Next(); ) {
+        for (const Entry& entry : cursor.Block()) {
+            if (!IsRemoved(entry.doc_id)) {
+                result.push_back(entry);
+            }
+        }
     }
-    return {};
+    return result;
+}
+
+PostingsView InvertedIndex::GetPostings(string_view word) const {
+    if (IsCompressed()) {
+        throw logic_error("Postings are compressed, use GetCursor");
+    }
+    if (segment_) {
+        const uint32_t term_id = segment_->FindTerm(word);
+        return term_id == IndexSegment::kNoTerm ? PostingsView() : segment_->Postings(term_id);
+    }
+    const uint32_t term_id = freq_dictionary_.terms.Find(word);
+    if (term_id == TermDictionary::kNoTerm) {
+        return {};
+    }
+    const auto& entries = freq_dictionary_.postings[term_id];
+    return PostingsView(entries.data(), entries.size());
+}
+
+PostingCursor InvertedIndex::GetCursor(string_view word) const {
+    if (segment_) {
+        const uint32_t term_id = segment_->FindTerm(word);
+        return term_id == IndexSegment::kNoTerm ? PostingCursor() : segment_->Cursor(term_id);
+    }
+    const uint32_t term_id = freq_dictionary_.terms.Find(word);
+    if (term_id == TermDictionary::kNoTerm) {
+        return {};
+    }
+    if (IsCompressed()) {
+        return compressed_.Cursor(term_id);
+    }
+    const auto& entries = freq_dictionary_.postings[term_id];
+    return PostingCursor(PostingsView(entries.data(), entries.size()));
+}
+
+size_t InvertedIndex::GetDocumentCount() const {
+    return segment_ ? segment_->DocumentCount() : documents_.size();
+}
+
+DocumentInfo InvertedIndex::GetDocumentInfo(size_t doc_id) const {
+    if (doc_id >= GetDocumentCount()) {
+        throw out_of_range("Unknown document id: " + to_string(doc_id));
+    }
+    if (segment_) {
+        return DocumentInfo{segment_->DocumentLength(doc_id),
+                            segment_->DocumentTokenCount(doc_id),
+                            string(segment_->DocumentSource(doc_id))};
+    }
+    return documents_[doc_id];
+}
+
+bool InvertedIndex::IsCompressed() const {
+    return segment_ ? segment_->IsCompressed() : compressed_.ListCount() > 0;
 }
 
 // Добавляем недостающие методы для SearchServer
-bool InvertedIndex::ContainsWord(const string& word) const {
-    return freq_dictionary_.find(word) != freq_dictionary_.end();
+bool InvertedIndex::ContainsWord(string_view word) const {
+    if (segment_) {
+        return segment_->FindTerm(word) != IndexSegment::kNoTerm;
+    }
+    const uint32_t term_id = freq_dictionary_.terms.Find(word);
+    if (term_id == TermDictionary::kNoTerm) {
+        return false;
+    }
+    if (IsCompressed()) {
+        return true;
+    }
+    // После изменений у слова могут не остаться действующие вхождения
+    const auto& entries = freq_dictionary_.postings[term_id];
+    return any_of(entries.begin(), entries.end(),
+                  [this](const Entry& entry) { return !IsRemoved(entry.doc_id); });
 }
 
 IndexStats InvertedIndex::GetStats() const {
     IndexStats stats;
-    stats.totalDocuments = docs_.size();
-    stats.totalWords = freq_dictionary_.size();
+
+    if (segment_) {
+        stats.totalDocuments = segment_->DocumentCount() - segment_->RemovedCount();
+        stats.totalWords = segment_->TermCount();
+        for (uint32_t term_id = 0; term_id < segment_->TermCount(); ++term_id) {
+            stats.totalEntries += segment_->PostingCount(term_id);
+        }
+        stats.postingBytes = segment_->PostingBytes();
+        return stats;
+    }
+
+    stats.totalDocuments = documents_.size() - removed_count_;
     
-    for (const auto& [word, entries] : freq_dictionary_) {
-        stats.totalEntries += entries.size();
+    if (IsCompressed()) {
+        stats.totalWords = freq_dictionary_.terms.Size();
+        for (size_t term_id = 0; term_id < compressed_.ListCount(); ++term_id) {
+            stats.totalEntries += compressed_.PostingCount(term_id);
+        }
+        stats.postingBytes = compressed_.ByteSize();
+    } else {
+        // Учитываются только вхождения действующих документов
+        for (const auto& entries : freq_dictionary_.postings) {
+            size_t live = entries.size();
+            if (HasRemovedDocuments()) {
+                live = count_if(entries.begin(), entries.end(),
+                                [this](const Entry& entry) { return !IsRemoved(entry.doc_id); });
+            }
+            stats.totalWords += live > 0 ? 1 : 0;
+            stats.totalEntries += live;
+            stats.postingBytes += entries.capacity() * sizeof(Entry);
+        }
     }
     
     return stats;
 }
+
+void InvertedIndex::SaveSegment(const string& path) const {
+    if (segment_) {
+        throw logic_error("Index is already backed by a segment");
+    }
+
+    SegmentWriter writer(path, IsCompressed());
+
+    // Вхождения удаленных документов не сохраняются, слова без действующих
+    // вхождений пропускаются; сами пометки хранятся в метаданных документов
+    vector<Entry> live;
+    for (uint32_t term_id = 0; term_id < freq_dictionary_.terms.Size(); ++term_id) {
+        const string_view term = freq_dictionary_.terms.Term(term_id);
+        if (IsCompressed()) {
+            writer.AddEncodedTerm(term, compressed_.ListData(term_id), compressed_.ListSize(term_id));
+        } else if (HasRemovedDocuments()) {
+            const auto& entries = freq_dictionary_.postings[term_id];
+            live.clear();
+            copy_if(entries.begin(), entries.end(), back_inserter(live),
+                    [this](const Entry& entry) { return !IsRemoved(entry.doc_id); });
+            if (!live.empty()) {
+                writer.AddTerm(term, live);
+            }
+        } else {
+            writer.AddTerm(term, freq_dictionary_.postings[term_id]);
+        }
+    }
+    for (size_t doc_id = 0; doc_id < documents_.size(); ++doc_id) {
+        const DocumentInfo& info = documents_[doc_id];
+        writer.AddDocument(info.length, info.tokenCount, info.source, IsRemoved(doc_id));
+    }
+
+    writer.Finish();
+}
+
+void InvertedIndex::LoadSegment(const string& path, bool verify) {
+    LoadSegment(IndexSegment::Open(path, verify));
+}
+
+void InvertedIndex::LoadSegment(unique_ptr<IndexSegment> segment) {
+    // Словари в памяти больше не нужны
+    documents_.clear();
+    removed_.clear();
+    removed_count_ = 0;
+    freq_dictionary_.Clear();
+    compressed_.Clear();
+
+    // Пометки удаленных документов переносятся из сегмента, чтобы IsRemoved
+    // и выдача поиска совпадали с индексом, который был сохранен
+    if (segment->RemovedCount() > 0) {
+        removed_.resize(segment->DocumentCount(), false);
+        for (size_t doc_id = 0; doc_id < segment->DocumentCount(); ++doc_id) {
+            removed_[doc_id] = segment->IsRemoved(doc_id);
+        }
+        removed_count_ = segment->RemovedCount();
+    }
+    segment_ = std::move(segment);
+}
+
+void InvertedIndex::ensureMutable() const {
+    if (segment_ || IsCompressed()) {
+        throw logic_error("Incremental updates require an uncompressed in-memory index");
+    }
+}
+
+// Вставка вхождений документа; списки остаются упорядоченными по doc_id.
+// Возвращает число слов документа
+size_t InvertedIndex::insertDocument(size_t doc_id, const string& text) {
+    Tokenizer tokenizer;
+    const size_t token_count = countWords(text, tokenizer, freq_dictionary_.terms, update_counts_);
+    freq_dictionary_.postings.resize(freq_dictionary_.terms.Size());
+
+    for (uint32_t term_id : update_counts_.touched) {
+        auto& entries = freq_dictionary_.postings[term_id];
+        auto it = lower_bound(entries.begin(), entries.end(), doc_id,
+                              [](const Entry& entry, size_t id) { return entry.doc_id < id; });
+        entries.insert(it, {doc_id, update_counts_.counts[term_id]});
+        update_counts_.counts[term_id] = 0;
+    }
+    update_counts_.touched.clear();
+    return token_count;
+}
+
+// Удаление вхождений документа. Текст документа не хранится, поэтому
+// просматриваются все списки — двоичным поиском по doc_id в каждом
+void InvertedIndex::purgeDocument(size_t doc_id) {
+    for (auto& entries : freq_dictionary_.postings) {
+        if (entries.empty() || entries.back().doc_id < doc_id) {
+            continue;
+        }
+        auto it = lower_bound(entries.begin(), entries.end(), doc_id,
+                              [](const Entry& entry, size_t id) { return entry.doc_id < id; });
+        if (it != entries.end() && it->doc_id == doc_id) {
+            entries.erase(it);
+        }
+    }
+}
+
+size_t InvertedIndex::AddDocument(const string& text, const string& source) {
+    ensureMutable();
+
+    const size_t doc_id = documents_.size();
+    const size_t token_count = insertDocument(doc_id, text);
+    documents_.push_back(DocumentInfo{text.size(), token_count, source});
+    removed_.resize(documents_.size(), false);
+    return doc_id;
+}
+
+// doc_id больше всех имеющихся в out: вхождения добавляются в конец списков
+void InvertedIndex::appendTerms(size_t doc_id, const DocumentTerms& terms, PostingStore& out) {
+    for (const DocumentTerms::Term& term : terms.terms) {
+        const uint32_t term_id = out.terms.Intern(terms.Word(term));
+        if (term_id == out.postings.size()) {
+            out.postings.emplace_back();
+        }
+        out.postings[term_id].push_back({doc_id, term.count});
+    }
+}
+
+size_t InvertedIndex::AddDocument(const DocumentTerms& terms, const string& source) {
+    ensureMutable();
+
+    const size_t doc_id = documents_.size();
+    appendTerms(doc_id, terms, freq_dictionary_);
+    documents_.push_back(DocumentInfo{terms.length, terms.tokenCount, source});
+    removed_.resize(documents_.size(), false);
+    return doc_id;
+}
+
+size_t InvertedIndex::BeginDocumentBase(size_t doc_count) {
+    clearDocumentBase(doc_count);
+    build_shards_.resize(max<size_t>(1, resolveThreadCount(doc_count)));
+    return build_shards_.size();
+}
+
+// Каждый шард пишет только в свои списки и в метаданные своих doc_id
+void InvertedIndex::AddDocument(size_t shard, size_t doc_id, const DocumentTerms& terms,
+                                const string& source) {
+    if (shard >= build_shards_.size() || doc_id >= documents_.size()) {
+        throw out_of_range("Unknown shard or document id: " + to_string(shard) + ", " + to_string(doc_id));
+    }
+    appendTerms(doc_id, terms, build_shards_[shard]);
+    documents_[doc_id] = DocumentInfo{terms.length, terms.tokenCount, source};
+}
+
+void InvertedIndex::FinishDocumentBase() {
+    if (!build_shards_.empty()) {
+        mergeShards(build_shards_);
+        freq_dictionary_ = std::move(build_shards_[0]);
+        build_shards_.clear();
+    }
+    compressPostings();
+}
+
+void InvertedIndex::UpdateDocument(size_t doc_id, const string& text) {
+    ensureMutable();
+    if (doc_id >= documents_.size()) {
+        throw out_of_range("Unknown document id: " + to_string(doc_id));
+    }
+
+    purgeDocument(doc_id);
+    documents_[doc_id].length = text.size();
+    documents_[doc_id].tokenCount = insertDocument(doc_id, text);
+
+    // Замена удаленного документа возвращает его в индекс
+    if (IsRemoved(doc_id)) {
+        removed_[doc_id] = false;
+        --removed_count_;
+    }
+}
+
+void InvertedIndex::RemoveDocument(size_t doc_id) {
+    ensureMutable();
+    if (doc_id >= documents_.size()) {
+        throw out_of_range("Unknown document id: " + to_string(doc_id));
+    }
+    if (IsRemoved(doc_id)) {
+        return;
+    }
+
+    removed_.resize(documents_.size(), false);
+    removed_[doc_id] = true;
+    ++removed_count_;
+}
+
+// Пометки удаленных документов остаются, чтобы doc_id не были переиспользованы
+void InvertedIndex::Compact() {
+    ensureMutable();
+    if (!HasRemovedDocuments()) {
+        return;
+    }
+
+    for (auto& entries : freq_dictionary_.postings) {
+        entries.erase(remove_if(entries.begin(), entries.end(),
+                                [this](const Entry& entry) { return IsRemoved(entry.doc_id); }),
+                      entries.end());
+    }
+}
@@ -0,0 +1,165 @@
+#include "JsonSaxReader.h"
+#include <utility>
+
+// Обработчик событий nlohmann::json::sax_parse.
+// depth — вложенность текущего события: 1 — внутри корневого объекта,
+// 2 — внутри значения одного из его ключей и т.д.
+class JsonSaxReader::Handler {
+public:
+    using json = nlohmann::json;
+
+    explicit Handler(JsonSaxReader& reader) : reader(reader) {}
+
+    bool null() { return scalar(json(nullptr)); }
+    bool boolean(bool value) { return scalar(json(value)); }
+    bool number_integer(json::number_integer_t value) { return scalar(json(value)); }
+    bool number_unsigned(json::number_unsigned_t value) { return scalar(json(value)); }
+    bool number_float(json::number_float_t value, const json::string_t&) { return scalar(json(value)); }
+    bool binary(json::binary_t& value) { return scalar(json(json::binary_t(std::move(value)))); }
+
+    bool string(json::string_t& value) {
+        if (mode == Mode::Stream && depth == 2) {
+            (*sink)(value);
+            return true;
+        }
+        if (mode == Mode::Keep) {
+            return scalar(json(std::move(value)));
+        }
+        return true;
+    }
+
+    bool start_object(std::size_t) { return startContainer(json::object(), false); }
+    bool start_array(std::size_t) { return startContainer(json::array(), true); }
+
+    bool key(json::string_t& name) {
+        if (depth == 1) {
+            if (!rootIsObject) {
+                return true;
+            }
+            currentKey = name;
+            if (reader.streams.count(name)) {
+                mode = Mode::Stream;
+                sink = &reader.streams[name];
+                reader.seen[name] = false;
+            } else if (reader.kept.count(name)) {
+                mode = Mode::Keep;
+                reader.kept[name] = json();
+                reader.seen[name] = false;
+            } else {
+                mode = Mode::Skip;
+            }
+        } else if (mode == Mode::Keep) {
+            pendingKey = std::move(name);
+        }
+        return true;
+    }
+
+    bool end_object() { return endContainer(); }
+    bool end_array() { return endContainer(); }
+
+    template <class Exception>
+    bool parse_error(std::size_t, const std::string&, const Exception& error) {
+        throw error;
+    }
+
+private:
+    enum class Mode { None, Skip, Stream, Keep };
+
+    bool scalar(json value) {
+        if (mode != Mode::Keep) {
+            return true;
+        }
+        if (depth == 1) {
+            // Скалярное значение ключа из Keep
+            reader.kept[currentKey] = std::move(value);
+            mode = Mode::None;
+            return true;
+        }
+        add(std::move(value));
+        return true;
+    }
+
+    bool startContainer(json empty, bool isArray) {
+        if (depth == 0) {
+            rootIsObject = !isArray;
+        } else if (depth == 1) {
+            if (mode == Mode::Keep) {
+                json& root = reader.kept[currentKey];
+                root = std::move(empty);
+                stack.push_back(&root);
+            } else if (mode == Mode::Stream) {
+                if (isArray) {
+                    reader.seen[currentKey] = true;
+                } else {
+                    mode = Mode::Skip;
+                }
+            }
+        } else if (mode == Mode::Keep) {
+            stack.push_back(&add(std::move(empty)));
+        }
+        ++depth;
+        return true;
+    }
+
+    bool endContainer() {
+        --depth;
+        if (mode == Mode::Keep) {
+            stack.pop_back();
+        }
+        if (depth == 1) {
+            mode = Mode::None;
+        }
+        return true;
+    }
+
+    // Добавление значения в собираемый контейнер; у объектов повторный ключ
+    // перезаписывает прежнее значение, как в DOM
+    json& add(json value) {
+        json& parent = *stack.back();
+        if (parent.is_object()) {
+            json& slot = parent[pendingKey];
+            slot = std::move(value);
+            return slot;
+        }
+        parent.push_back(std::move(value));
+        return parent.back();
+    }
+
+    JsonSaxReader& reader;
+    std::size_t depth = 0;
+    bool rootIsObject = false;
+    Mode mode = Mode::None;
+    std::string currentKey;
+    std::string pendingKey;
+    StringSink* sink = nullptr;
+    std::vector<json*> stack;
+};
+
+void JsonSaxReader::StreamStrings(const std::string& key, StringSink sink) {
+    streams[key] = std::move(sink);
+}
+
+void JsonSaxReader::Keep(const std::string& key) {
+    kept[key] = nlohmann::json();
+}
+
+void JsonSaxReader::Parse(std::istream& input) {
+    seen.clear();
+    Handler handler(*this);
+    nlohmann::json::sax_parse(input, &handler, nlohmann::json::input_format_t::json, false);
+}
+
+bool JsonSaxReader::Contains(const std::string& key) const {
+    return seen.count(key) > 0;
+}
+
+const nlohmann::json& JsonSaxReader::Kept(const std::string& key) const {
+    static const nlohmann::json missing;
+    const auto it = kept.find(key);
+    return it == kept.end() ? missing : it->second;
+}
+
+bool JsonSaxReader::WasArray(const std::string& key) const {
+    const auto it = seen.find(key);
+    return it != seen.end() && it->second;
+}
@@ -0,0 +1,88 @@
+#include "RequestSource.h"
+#include "JsonSaxReader.h"
+#include "Utf8.h"
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+RequestSource::RequestSource(const std::string& path) : path(path) {
+    file.open(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open requests file: " + path);
+    }
+
+    jsonLines = path.size() >= 6 && path.compare(path.size() - 6, 6, ".jsonl") == 0;
+    if (jsonLines) {
+        return;
+    }
+
+    // Строки массива "requests" переносятся в loaded прямо во время разбора
+    JsonSaxReader reader;
+    reader.StreamStrings("requests", [this](std::string& request) {
+        if (!request.empty()) {
+            loaded.push_back(std::move(request));
+        }
+    });
+    reader.Parse(file);
+    file.close();
+}
+
+bool RequestSource::parseLine(const std::string& line, std::string& request) {
+    // Частый случай — строка без экранирования: запрос берется как есть
+    if (line.size() >= 2 && line.front() == '"' && line.back() == '"') {
+        bool plain = true;
+        for (size_t i = 1; i + 1 < line.size(); ++i) {
+            const unsigned char c = static_cast<unsigned char>(line[i]);
+            if (c == '"' || c == '\\' || c < 0x20) {
+                plain = false;
+                break;
+            }
+        }
+        if (plain && Utf8::IsValid(std::string_view(line).substr(1, line.size() - 2))) {
+            request.assign(line, 1, line.size() - 2);
+            return true;
+        }
+    }
+
+    const nlohmann::json value = nlohmann::json::parse(line, nullptr, false);
+    if (value.is_string()) {
+        request = value.get<std::string>();
+        return true;
+    }
+    if (value.is_object() && value.contains("request") && value["request"].is_string()) {
+        request = value["request"].get<std::string>();
+        return true;
+    }
+    return false;
+}
+
+bool RequestSource::Next(std::string& request) {
+    if (!jsonLines) {
+        if (position >= loaded.size()) {
+            return false;
+        }
+        // Запрос отдается один раз, копия в loaded больше не нужна
+        request = std::move(loaded[position++]);
+        return true;
+    }
+
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.find_first_not_of(" \t") == std::string::npos) {
+            continue;
+        }
+        if (!parseLine(line, request)) {
+            ++skippedLines;
+            std::cerr << "Warning: Invalid request at " << path << ":" << lineNumber << std::endl;
+            continue;
+        }
+        if (!request.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
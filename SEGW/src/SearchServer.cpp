@@ -1,149 +1,139 @@
 #include "SearchServer.h"
+#include "BoundedQueue.h"
 #include <algorithm>
-#include <sstream>
 #include <cmath>
+#include <exception>
 #include <thread>
-#include <mutex>
-#include <future>
 
 // Конструктор
-SearchServer::SearchServer(InvertedIndex& idx) : index(idx) {}
+SearchServer::SearchServer(InvertedIndex& idx, size_t threadPoolSize)
+    : index(idx),
+      pool(std::make_unique<ThreadPool>(threadPoolSize)) {}
 
 // Деструктор
 SearchServer::~SearchServer() {}
 
-// Нормализация слова (аналогично InvertedIndex)
-std::string SearchServer::normalizeWord(const std::string& word) const {
-    std::string normalized;
-    normalized.reserve(word.size());
-    
-    for (char c : word) {
-        if (std::isalpha(static_cast<unsigned char>(c))) {
-            normalized += std::tolower(static_cast<unsigned char>(c));
-        }
-    }
-    
-    if (normalized.length() > MAX_WORD_LENGTH) {
-        normalized = normalized.substr(0, MAX_WORD_LENGTH);
-    }
-    
-    return normalized;
-}
-
 // Разбивка запроса на слова
-std::vector<std::string> SearchServer::splitQuery(const std::string& query) const {
-    std::vector<std::string> words;
-    std::istringstream stream(query);
-    std::string word;
-    
-    while (stream >> word) {
-        std::string normalizedWord = normalizeWord(word);
-        if (!normalizedWord.empty()) {
-            words.push_back(normalizedWord);
-        }
+void SearchServer::splitQuery(const std::string& query, Tokenizer& tokenizer,
+                              std::vector<std::string_view>& words) const {
+    words.clear();
+    
+    for (std::string_view word : tokenizer.Tokenize(query)) {
+        words.push_back(word.substr(0, MAX_WORD_LENGTH));
     }
     
     // Удаляем дубликаты и сортируем для оптимизации
     std::sort(words.begin(), words.end());
     words.erase(std::unique(words.begin(), words.end()), words.end());
-    
-    return words;
 }
 
-// Вычисление релевантности документа для запроса
-float SearchServer::calculateRelevance(const std::vector<std::string>& queryWords, 
-                                     size_t docId) const {
-    float relevance = 0.0f;
-    size_t totalWordsInQuery = queryWords.size();
-    
-    if (totalWordsInQuery == 0) {
-        return 0.0f;
+// Подготовка аккумуляторов под текущий размер индекса
+void SearchServer::ScoreAccumulator::Reset(size_t docCount) {
+    if (scores.size() < docCount) {
+        scores.resize(docCount, 0);
+        touched.resize((docCount + 63) / 64, 0);
     }
-    
-    // Подсчитываем абсолютную релевантность
-    size_t absoluteRelevance = 0;
-    
-    for (const std::string& word : queryWords) {
-        auto wordCount = index.GetWordCount(word);
-        
-        // Ищем документ в списке
-        for (const auto& entry : wordCount) {
-            if (entry.doc_id == docId) {
-                absoluteRelevance += entry.count;
-                break;
+}
+
+void SearchServer::ScoreAccumulator::Add(size_t docId, size_t count) {
+    scores[docId] += count;
+    touched[docId / 64] |= uint64_t{1} << (docId % 64);
+}
+
+namespace {
+
+// Порядок выдачи: по убыванию релевантности, при равной — по возрастанию ID
+bool ranksBefore(const std::pair<size_t, size_t>& a, const std::pair<size_t, size_t>& b) {
+    const float rankA = static_cast<float>(a.second);
+    const float rankB = static_cast<float>(b.second);
+    if (rankA != rankB) {
+        return rankA > rankB;
+    }
+    return a.first < b.first;
+}
+
+} // namespace
+
+void SearchServer::ScoreAccumulator::SelectTop(size_t k) {
+    top.clear();
+
+    // Куча фиксированного размера k: на вершине худший из отобранных документов.
+    // Документы перебираются по возрастанию doc_id, поэтому документ с равной
+    // релевантностью никогда не вытесняет уже отобранный
+    for (size_t word = 0; word < touched.size(); ++word) {
+        uint64_t bits = touched[word];
+        while (bits != 0) {
+            const size_t docId = word * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+            const std::pair<size_t, size_t> candidate(docId, scores[docId]);
+
+            if (top.size() < k) {
+                top.push_back(candidate);
+                std::push_heap(top.begin(), top.end(), ranksBefore);
+            } else if (k > 0 && ranksBefore(candidate, top.front())) {
+                std::pop_heap(top.begin(), top.end(), ranksBefore);
+                top.back() = candidate;
+                std::push_heap(top.begin(), top.end(), ranksBefore);
             }
+
+            scores[docId] = 0;
+            bits &= bits - 1;
         }
+        touched[word] = 0;
     }
-    
-    // Нормализуем релевантность (простая нормализация)
-    if (absoluteRelevance > 0) {
-        // Можно использовать более сложные алгоритмы типа TF-IDF
-        relevance = static_cast<float>(absoluteRelevance);
-    }
-    
-    return relevance;
+
+    std::sort_heap(top.begin(), top.end(), ranksBefore);
 }
 
 // Обработка одного запроса
 std::vector<RelativeIndex> SearchServer::processQuery(const std::string& query, 
-                                                    size_t maxResponses) const {
+                                                    size_t maxResponses,
+                                                    QueryScratch& scratch) const {
     std::vector<RelativeIndex> result;
     
     // Разбиваем запрос на слова
-    std::vector<std::string> queryWords = splitQuery(query);
+    std::vector<std::string_view>& queryWords = scratch.words;
+    splitQuery(query, scratch.tokenizer, queryWords);
+    ScoreAccumulator& accumulator = scratch.accumulator;
     
     if (queryWords.empty()) {
         return result; // Пустой результат для пустого запроса
     }
     
-    // Находим все документы, содержащие хотя бы одно слово из запроса
-    std::set<size_t> candidateDocuments;
+    // Один проход по списку вхождений каждого слова: абсолютная релевантность
+    // накапливается в массиве, индексированном doc_id
+    accumulator.Reset(index.GetDocumentCount());
     
-    for (const std::string& word : queryWords) {
-        if (index.ContainsWord(word)) {
-            auto wordCount = index.GetWordCount(word);
-            for (const auto& entry : wordCount) {
-                candidateDocuments.insert(entry.doc_id);
+    const bool skipRemoved = index.HasRemovedDocuments();
+    
+    for (std::string_view word : queryWords) {
+        for (PostingCursor cursor = index.GetCursor(word); cursor.Next(); ) {
+            for (const Entry& entry : cursor.Block()) {
+                if (skipRemoved && index.IsRemoved(entry.doc_id)) {
+                    continue; // документ удален, вхождение ждет Compact
+                }
+                accumulator.Add(entry.doc_id, entry.count);
             }
         }
     }
     
-    // Вычисляем релевантность для каждого документа-кандидата
-    std::vector<std::pair<size_t, float>> documentRelevance;
-    documentRelevance.reserve(candidateDocuments.size());
+    // Отбираем maxResponses лучших документов без полной сортировки
+    accumulator.SelectTop(maxResponses);
+    const auto& top = accumulator.top;
     
-    for (size_t docId : candidateDocuments) {
-        float relevance = calculateRelevance(queryWords, docId);
-        if (relevance > 0.0f) {
-            documentRelevance.emplace_back(docId, relevance);
-        }
+    if (top.empty()) {
+        return result;
     }
     
-    // Сортируем по убыванию релевантности
-    std::sort(documentRelevance.begin(), documentRelevance.end(),
-              [](const auto& a, const auto& b) {
-                  if (std::abs(a.second - b.second) < 0.001f) {
-                      return a.first < b.first; // При равной релевантности сортируем по ID
-                  }
-                  return a.second > b.second;
-              });
-    
     // Нормализуем релевантность к диапазону [0, 1]
-    if (!documentRelevance.empty()) {
-        float maxRelevance = documentRelevance[0].second;
+    const float maxRelevance = static_cast<float>(top.front().second);
+    result.reserve(top.size());
+    
+    for (const auto& [docId, absoluteRelevance] : top) {
+        float relevance = static_cast<float>(absoluteRelevance);
         if (maxRelevance > 0.0f) {
-            for (auto& [docId, relevance] : documentRelevance) {
-                relevance /= maxRelevance;
-            }
+            relevance /= maxRelevance;
         }
-    }
-    
-    // Ограничиваем количество результатов
-    size_t resultCount = std::min(documentRelevance.size(), maxResponses);
-    result.reserve(resultCount);
-    
-    for (size_t i = 0; i < resultCount; ++i) {
-        result.emplace_back(documentRelevance[i].first, documentRelevance[i].second);
+        result.emplace_back(docId, relevance);
     }
     
     return result;
@@ -159,37 +149,28 @@ std::vector<std::vector<RelativeIndex>> SearchServer::search(
         return results;
     }
     
-    // Определяем количество потоков
-    const size_t numThreads = std::min(
-        static_cast<size_t>(std::thread::hardware_concurrency()),
-        queries_input.size()
-    );
-    
-    if (numThreads <= 1) {
+    if (queries_input.size() == 1 || pool->Size() <= 1) {
         // Однопоточная обработка для малого количества запросов
+        QueryScratch scratch;
         for (size_t i = 0; i < queries_input.size(); ++i) {
-            results[i] = processQuery(queries_input[i], maxResponses);
-        }
-    } else {
-        // Многопоточная обработка
-        std::vector<std::future<std::vector<RelativeIndex>>> futures;
-        futures.reserve(queries_input.size());
-        
-        // Запускаем асинхронные задачи для каждого запроса
-        for (size_t i = 0; i < queries_input.size(); ++i) {
-            futures.emplace_back(
-                std::async(std::launch::async, [this, &queries_input, i, maxResponses]() {
-                    return processQuery(queries_input[i], maxResponses);
-                })
-            );
-        }
-        
-        // Собираем результаты
-        for (size_t i = 0; i < futures.size(); ++i) {
-            results[i] = futures[i].get();
+            results[i] = processQuery(queries_input[i], maxResponses, scratch);
         }
+        return results;
     }
     
+    // Многопоточная обработка: запросы передаются пулу блоками, по нескольку
+    // блоков на поток, чтобы простаивающие потоки могли забрать чужую работу
+    const size_t chunkSize = std::max<size_t>(1, queries_input.size() / (pool->Size() * 8));
+    std::vector<QueryScratch> workerScratch(pool->Size()); // по одному на рабочий поток
+    
+    pool->ParallelFor(queries_input.size(), chunkSize,
+                      [this, &queries_input, &results, &workerScratch, maxResponses](size_t begin, size_t end, size_t worker) {
+                          QueryScratch& scratch = workerScratch[worker];
+                          for (size_t i = begin; i < end; ++i) {
+                              results[i] = processQuery(queries_input[i], maxResponses, scratch);
+                          }
+                      });
+    
     return results;
 }
 
@@ -207,14 +188,16 @@ SearchServer::SearchStats SearchServer::getSearchStats(
     }
     
     size_t totalWords = 0;
+    Tokenizer tokenizer;
+    std::vector<std::string_view> words;
     
     for (const std::string& query : queries_input) {
-        std::vector<std::string> words = splitQuery(query);
+        splitQuery(query, tokenizer, words);
         totalWords += words.size();
         
         // Проверяем, есть ли результаты для запроса
         bool hasResults = false;
-        for (const std::string& word : words) {
+        for (std::string_view word : words) {
             if (index.ContainsWord(word)) {
                 hasResults = true;
                 break;
@@ -230,4 +213,80 @@ SearchServer::SearchStats SearchServer::getSearchStats(
                                 static_cast<float>(queries_input.size());
     
     return stats;
-}
\ No newline at end of file
+}
+
+SearchServer::SearchStats SearchServer::searchStream(const RequestReader& next, const ResultSink& sink,
+                                                     size_t maxResponses, size_t batchSize) const {
+    batchSize = std::max<size_t>(1, batchSize);
+
+    // Пока пул обрабатывает один пакет, читатель готовит следующие
+    BoundedQueue<std::vector<std::string>> batches(2);
+    std::exception_ptr readFailure;
+    std::thread reader([&]() {
+        try {
+            std::vector<std::string> batch;
+            std::string request;
+            while (next(request)) {
+                batch.push_back(std::move(request));
+                if (batch.size() == batchSize) {
+                    if (!batches.Push(std::move(batch))) {
+                        return;
+                    }
+                    batch = std::vector<std::string>();
+                    batch.reserve(batchSize);
+                }
+            }
+            if (!batch.empty()) {
+                batches.Push(std::move(batch));
+            }
+        } catch (...) {
+            readFailure = std::current_exception();
+        }
+        batches.Close();
+    });
+
+    SearchStats stats;
+    size_t totalWords = 0;
+    std::vector<QueryScratch> workerScratch(pool->Size()); // по одному на рабочий поток
+    std::vector<size_t> workerWords(workerScratch.size(), 0);
+    std::vector<std::vector<RelativeIndex>> results;
+    std::vector<std::string> batch;
+
+    try {
+        while (batches.Pop(batch)) {
+            results.assign(batch.size(), std::vector<RelativeIndex>());
+            pool->ParallelFor(batch.size(), std::max<size_t>(1, batch.size() / (pool->Size() * 8)),
+                              [&](size_t begin, size_t end, size_t worker) {
+                                  QueryScratch& scratch = workerScratch[worker];
+                                  for (size_t i = begin; i < end; ++i) {
+                                      results[i] = processQuery(batch[i], maxResponses, scratch);
+                                      workerWords[worker] += scratch.words.size();
+                                  }
+                              });
+            for (auto& result : results) {
+                if (!result.empty()) {
+                    stats.queriesWithResults++;
+                }
+                sink(stats.totalQueries++, result);
+            }
+        }
+    } catch (...) {
+        // Читатель не должен остаться ждать места в очереди
+        batches.Close();
+        reader.join();
+        throw;
+    }
+    reader.join();
+    if (readFailure) {
+        std::rethrow_exception(readFailure);
+    }
+
+    for (size_t words : workerWords) {
+        totalWords += words;
+    }
+    if (stats.totalQueries > 0) {
+        stats.averageWordsPerQuery = static_cast<float>(totalWords) /
+                                     static_cast<float>(stats.totalQueries);
+    }
+    return stats;
+}
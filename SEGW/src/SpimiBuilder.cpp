@@ -0,0 +1,345 @@
+#include "SpimiBuilder.h"
+#include "CompressedPostings.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+
+namespace {
+
+void writeVarint(std::FILE* file, uint64_t value) {
+    uint8_t bytes[10];
+    size_t size = 0;
+    while (value >= 0x80) {
+        bytes[size++] = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    bytes[size++] = static_cast<uint8_t>(value);
+    std::fwrite(bytes, 1, size, file);
+}
+
+bool readVarint(std::FILE* file, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        const int byte = std::getc(file);
+        if (byte == EOF) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Последовательное чтение одного run-файла. Список текущего слова декодируется
+// из файла поблочно, так что в памяти не бывает больше одного блока
+class RunReader {
+public:
+    explicit RunReader(const std::string& path) : path(path) {
+        file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            throw std::runtime_error("Cannot open index run: " + path);
+        }
+    }
+    ~RunReader() {
+        std::fclose(file);
+    }
+
+    // Переход к следующему слову; false в конце файла.
+    // Список предыдущего слова должен быть дочитан через NextBlock
+    bool Next() {
+        uint64_t termSize = 0;
+        if (!readVarint(file, termSize)) {
+            return false;
+        }
+        term.resize(termSize);
+        if (std::fread(term.data(), 1, termSize, file) != termSize) {
+            throw std::runtime_error("Truncated index run: " + path);
+        }
+        count = readListVarint();
+        remaining = count;
+        lastDocId = 0;
+        return true;
+    }
+
+    // Число вхождений текущего слова
+    size_t Count() const { return count; }
+
+    // Следующий блок списка текущего слова; false, если список исчерпан
+    bool NextBlock() {
+        if (remaining == 0) {
+            return false;
+        }
+        const size_t size = std::min(remaining, PostingCursor::kBlockSize);
+        for (size_t i = 0; i < size; ++i) {
+            lastDocId += readListVarint();
+            block[i].doc_id = lastDocId;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            block[i].count = readListVarint() + 1;
+        }
+        remaining -= size;
+        blockSize = size;
+        return true;
+    }
+
+    PostingsView Block() const { return PostingsView(block, blockSize); }
+
+    std::string term;
+
+private:
+    uint64_t readListVarint() {
+        uint64_t value = 0;
+        if (!readVarint(file, value)) {
+            throw std::runtime_error("Truncated index run: " + path);
+        }
+        return value;
+    }
+
+    std::string path;
+    std::FILE* file = nullptr;
+    size_t count = 0;
+    size_t remaining = 0;
+    size_t lastDocId = 0;
+    Entry block[PostingCursor::kBlockSize];
+    size_t blockSize = 0;
+};
+
+// Последовательная запись run-файла; слова подаются по возрастанию.
+// Интерфейс записи слова тот же, что у SegmentWriter: BeginTerm, AppendPostings, EndTerm
+class RunWriter {
+public:
+    explicit RunWriter(const std::string& path) : path(path) {
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            throw std::runtime_error("Cannot create index run: " + path);
+        }
+    }
+    ~RunWriter() {
+        if (file) {
+            std::fclose(file);
+        }
+    }
+
+    void BeginTerm(std::string_view term, size_t postingCount) {
+        writeVarint(file, term.size());
+        std::fwrite(term.data(), 1, term.size(), file);
+        encoder.Begin(postingCount, encoded);
+        flush();
+    }
+
+    void AppendPostings(PostingsView entries) {
+        encoder.Add(entries, encoded);
+        flush();
+    }
+
+    void EndTerm() {
+        encoder.End(encoded);
+        flush();
+    }
+
+    void Close() {
+        const bool failed = std::ferror(file) != 0;
+        const bool closeFailed = std::fclose(file) != 0;
+        file = nullptr;
+        if (closeFailed || failed) {
+            throw std::runtime_error("Cannot write index run: " + path);
+        }
+    }
+
+private:
+    void flush() {
+        std::fwrite(encoded.data(), 1, encoded.size(), file);
+        encoded.clear();
+    }
+
+    std::string path;
+    std::FILE* file = nullptr;
+    PostingEncoder encoder;
+    std::vector<uint8_t> encoded;
+};
+
+// k-путевое слияние: run-файлы упорядочены по doc_id, поэтому для одного
+// слова списки склеиваются в порядке run-файлов. Число вхождений слова известно
+// заранее (сумма по run-файлам), и списки передаются в sink поблочно
+template <typename Sink>
+void mergeGroup(const std::vector<std::string>& paths, Sink& sink) {
+    std::vector<std::unique_ptr<RunReader>> readers;
+    for (const std::string& path : paths) {
+        readers.push_back(std::make_unique<RunReader>(path));
+    }
+
+    auto after = [&readers](size_t a, size_t b) {
+        const int order = readers[a]->term.compare(readers[b]->term);
+        return order != 0 ? order > 0 : a > b;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(after)> heap(after);
+    for (size_t run = 0; run < readers.size(); ++run) {
+        if (readers[run]->Next()) {
+            heap.push(run);
+        }
+    }
+
+    std::vector<size_t> sameTerm; // run-файлы с текущим словом, по возрастанию номера
+    std::string term;
+
+    while (!heap.empty()) {
+        term = readers[heap.top()]->term;
+        sameTerm.clear();
+        size_t postingCount = 0;
+        while (!heap.empty() && readers[heap.top()]->term == term) {
+            sameTerm.push_back(heap.top());
+            postingCount += readers[heap.top()]->Count();
+            heap.pop();
+        }
+
+        sink.BeginTerm(term, postingCount);
+        for (size_t run : sameTerm) {
+            while (readers[run]->NextBlock()) {
+                sink.AppendPostings(readers[run]->Block());
+            }
+            if (readers[run]->Next()) {
+                heap.push(run);
+            }
+        }
+        sink.EndTerm();
+    }
+}
+
+} // namespace
+
+SpimiBuilder::SpimiBuilder(const std::string& segmentPath, size_t memoryBudgetBytes, bool compressed)
+    : segmentPath(segmentPath), memoryBudget(memoryBudgetBytes), compressed(compressed),
+      writer(std::make_unique<SegmentWriter>(segmentPath, compressed)) {}
+
+SpimiBuilder::~SpimiBuilder() {
+    removeRuns();
+}
+
+size_t SpimiBuilder::MemoryUsage() const {
+    // Емкости списков, массива списков и всех структур словаря
+    return postingBytes + postings.capacity() * sizeof(std::vector<Entry>) + terms.MemoryUsage();
+}
+
+size_t SpimiBuilder::AddDocument(std::string_view text, std::string_view source) {
+    scratch.Assign(text, tokenizer);
+    return AddDocument(scratch, source);
+}
+
+size_t SpimiBuilder::AddDocument(const DocumentTerms& document, std::string_view source) {
+    if (finished) {
+        throw std::logic_error("SpimiBuilder is already finished");
+    }
+
+    const size_t docId = documentCount++;
+    for (const DocumentTerms::Term& term : document.terms) {
+        const uint32_t termId = terms.Intern(document.Word(term));
+        if (termId == postings.size()) {
+            postings.emplace_back();
+        }
+        std::vector<Entry>& list = postings[termId];
+        const size_t capacity = list.capacity();
+        list.push_back({docId, term.count});
+        postingBytes += (list.capacity() - capacity) * sizeof(Entry);
+    }
+
+    // Метаданные документа сразу уходят во временный файл сегмента
+    writer->AddDocument(document.length, document.tokenCount, source);
+
+    if (MemoryUsage() > memoryBudget) {
+        flushRun();
+    }
+    return docId;
+}
+
+// Сброс текущего словаря в run-файл, слова по возрастанию
+void SpimiBuilder::flushRun() {
+    if (terms.Empty()) {
+        return;
+    }
+
+    ++runCount;
+    const std::string path = newRunPath();
+    RunWriter run(path);
+
+    std::vector<uint32_t> order(terms.Size());
+    for (uint32_t termId = 0; termId < order.size(); ++termId) {
+        order[termId] = termId;
+    }
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return terms.Term(a) < terms.Term(b);
+    });
+
+    for (uint32_t termId : order) {
+        run.BeginTerm(terms.Term(termId), postings[termId].size());
+        run.AppendPostings(PostingsView(postings[termId].data(), postings[termId].size()));
+        run.EndTerm();
+    }
+    run.Close();
+
+    // Память освобождается, а не только очищается: иначе емкости остались бы в MemoryUsage
+    terms = TermDictionary();
+    std::vector<std::vector<Entry>>().swap(postings);
+    postingBytes = 0;
+}
+
+void SpimiBuilder::Finish() {
+    if (finished) {
+        return;
+    }
+    flushRun();
+    mergeRuns();
+    removeRuns();
+    finished = true;
+}
+
+std::string SpimiBuilder::newRunPath() {
+    std::string path = segmentPath + ".run" + std::to_string(runFileCount++);
+    runPaths.push_back(path); // удаляется в removeRuns, даже если запись оборвется
+    return path;
+}
+
+// Слияние не больше kMaxMergeFanIn run-файлов за раз: пока файлов больше, соседние
+// группы сливаются в промежуточные run-файлы (порядок doc_id сохраняется), и только
+// последний проход пишет сегмент. Число открытых файлов не зависит от размера корпуса
+void SpimiBuilder::mergeRuns() {
+    std::vector<std::string> level = runPaths;
+
+    while (level.size() > kMaxMergeFanIn) {
+        std::vector<std::string> next;
+        for (size_t begin = 0; begin < level.size(); begin += kMaxMergeFanIn) {
+            const std::vector<std::string> group(level.begin() + begin,
+                level.begin() + std::min(begin + kMaxMergeFanIn, level.size()));
+            if (group.size() == 1) {
+                next.push_back(group.front());
+                continue;
+            }
+
+            const std::string path = newRunPath();
+            RunWriter run(path);
+            mergeGroup(group, run);
+            run.Close();
+            next.push_back(path);
+
+            // Слитые файлы больше не нужны
+            for (const std::string& merged : group) {
+                std::remove(merged.c_str());
+                runPaths.erase(std::find(runPaths.begin(), runPaths.end(), merged));
+            }
+        }
+        level.swap(next);
+    }
+
+    mergeGroup(level, *writer);
+    writer->Finish();
+}
+
+void SpimiBuilder::removeRuns() {
+    for (const std::string& path : runPaths) {
+        std::remove(path.c_str());
+    }
+    runPaths.clear();
+}
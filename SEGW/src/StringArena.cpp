@@ -0,0 +1,39 @@
+#include "StringArena.h"
+#include <cstring>
+
+std::string_view StringArena::Store(std::string_view text) {
+    if (text.empty()) {
+        return {};
+    }
+    char* data = allocate(text.size());
+    std::memcpy(data, text.data(), text.size());
+    used_bytes_ += text.size();
+    return std::string_view(data, text.size());
+}
+
+void StringArena::Clear() {
+    blocks_.clear();
+    cursor_ = nullptr;
+    remaining_ = 0;
+    used_bytes_ = 0;
+    allocated_bytes_ = 0;
+}
+
+char* StringArena::allocate(size_t size) {
+    if (size > remaining_) {
+        // Строка длиннее блока получает отдельный блок, текущий блок продолжает заполняться
+        if (size > kBlockSize / 4) {
+            blocks_.push_back(std::make_unique<char[]>(size));
+            allocated_bytes_ += size;
+            return blocks_.back().get();
+        }
+        blocks_.push_back(std::make_unique<char[]>(kBlockSize));
+        allocated_bytes_ += kBlockSize;
+        cursor_ = blocks_.back().get();
+        remaining_ = kBlockSize;
+    }
+    char* data = cursor_;
+    cursor_ += size;
+    remaining_ -= size;
+    return data;
+}
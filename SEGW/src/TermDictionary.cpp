@@ -0,0 +1,115 @@
+#include "TermDictionary.h"
+#include <cstring>
+
+namespace {
+
+// Максимальная заполненность таблицы — 7/10
+bool needsGrow(size_t term_count, size_t slot_count) {
+    return (term_count + 1) * 10 > slot_count * 7;
+}
+
+uint64_t mix(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+} // namespace
+
+// Хеширование по 8 байт за шаг
+uint32_t TermDictionary::Hash(std::string_view term) {
+    uint64_t state = 0x9e3779b97f4a7c15ULL ^ term.size();
+    const char* data = term.data();
+    size_t remaining = term.size();
+
+    while (remaining >= 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, data, 8);
+        state = mix(state ^ chunk);
+        data += 8;
+        remaining -= 8;
+    }
+
+    uint64_t tail = 0;
+    std::memcpy(&tail, data, remaining);
+    state = mix(state ^ tail);
+
+    return static_cast<uint32_t>(state);
+}
+
+size_t TermDictionary::findSlot(std::string_view term, uint32_t hash) const {
+    const size_t mask = slots_.size() - 1;
+    size_t pos = hash & mask;
+
+    while (true) {
+        const Slot& slot = slots_[pos];
+        if (slot.term_id == kNoTerm) {
+            return pos;
+        }
+        if (slot.hash == hash && terms_[slot.term_id] == term) {
+            return pos;
+        }
+        pos = (pos + 1) & mask;
+    }
+}
+
+uint32_t TermDictionary::Find(std::string_view term) const {
+    if (slots_.empty()) {
+        return kNoTerm;
+    }
+    return slots_[findSlot(term, Hash(term))].term_id;
+}
+
+uint32_t TermDictionary::Intern(std::string_view term) {
+    if (needsGrow(terms_.size(), slots_.size())) {
+        rehash(slots_.empty() ? 16 : slots_.size() * 2);
+    }
+
+    const uint32_t hash = Hash(term);
+    Slot& slot = slots_[findSlot(term, hash)];
+    if (slot.term_id != kNoTerm) {
+        return slot.term_id;
+    }
+
+    slot.hash = hash;
+    slot.term_id = static_cast<uint32_t>(terms_.size());
+    terms_.push_back(arena_.Store(term));
+    hashes_.push_back(hash);
+    return slot.term_id;
+}
+
+void TermDictionary::Reserve(size_t term_count) {
+    size_t slot_count = slots_.empty() ? 16 : slots_.size();
+    while (needsGrow(term_count, slot_count)) {
+        slot_count *= 2;
+    }
+    if (slot_count != slots_.size()) {
+        rehash(slot_count);
+    }
+    terms_.reserve(term_count);
+    hashes_.reserve(term_count);
+}
+
+void TermDictionary::Clear() {
+    slots_.clear();
+    terms_.clear();
+    arena_.Clear();
+    hashes_.clear();
+}
+
+// Перестроение таблицы без повторного хеширования строк
+void TermDictionary::rehash(size_t slot_count) {
+    slots_.assign(slot_count, Slot{0, kNoTerm});
+    const size_t mask = slot_count - 1;
+
+    for (uint32_t term_id = 0; term_id < terms_.size(); ++term_id) {
+        size_t pos = hashes_[term_id] & mask;
+        while (slots_[pos].term_id != kNoTerm) {
+            pos = (pos + 1) & mask;
+        }
+        slots_[pos] = Slot{hashes_[term_id], term_id};
+    }
+}
@@ -0,0 +1,136 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <exception>
+
+// Конструктор: запуск рабочих потоков
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    queues.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+// Деструктор: остановка и ожидание рабочих потоков
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// Постановка задачи в очередь (очереди заполняются по кругу)
+void ThreadPool::submit(std::function<void(size_t)> task) {
+    const size_t target = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        pendingTasks.fetch_add(1, std::memory_order_release);
+    }
+    wakeCondition.notify_one();
+}
+
+bool ThreadPool::tryPop(size_t worker, std::function<void(size_t)>& task) {
+    WorkerQueue& queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::trySteal(size_t worker, std::function<void(size_t)>& task) {
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue& victim = *queues[(worker + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+    std::function<void(size_t)> task;
+
+    while (true) {
+        if (tryPop(worker, task) || trySteal(worker, task)) {
+            pendingTasks.fetch_sub(1, std::memory_order_acq_rel);
+            task(worker);
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this]() {
+            return stopping || pendingTasks.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping && pendingTasks.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+// Параллельная обработка диапазона блоками
+void ThreadPool::ParallelFor(size_t count, size_t chunkSize, const RangeTask& task) {
+    if (count == 0) {
+        return;
+    }
+    chunkSize = std::max<size_t>(1, chunkSize);
+
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    size_t remaining = chunkCount;
+    std::exception_ptr firstError;
+
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        const size_t begin = chunk * chunkSize;
+        const size_t end = std::min(begin + chunkSize, count);
+
+        submit([&, begin, end](size_t worker) {
+            std::exception_ptr error;
+            try {
+                task(begin, end, worker);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (error && !firstError) {
+                firstError = error;
+            }
+            if (--remaining == 0) {
+                doneCondition.notify_one();
+            }
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneCondition.wait(lock, [&remaining]() { return remaining == 0; });
+
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+}
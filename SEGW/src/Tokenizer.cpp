@@ -0,0 +1,301 @@
+#include "Tokenizer.h"
+
+#include <algorithm>
+#include "Utf8.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SEGW_TOKENIZER_X86 1
+#include <immintrin.h>
+#endif
+
+using TokenizerTables::kCharTable;
+using TokenizerTables::kSpace;
+
+namespace {
+
+constexpr size_t kBlockSize = 64;
+
+// Биты [begin, end) маски
+inline uint64_t bitRange(uint64_t mask, size_t begin, size_t end) {
+    const size_t width = end - begin;
+    if (width == 0) {
+        return 0;
+    }
+    const uint64_t keep = width >= 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+    return (mask >> begin) & keep;
+}
+
+} // namespace
+
+Tokenizer::BlockMasks Tokenizer::classifyScalar(const unsigned char* src, size_t size, char* dst) {
+    BlockMasks masks{0, 0, 0};
+    for (size_t i = 0; i < size; ++i) {
+        const uint8_t cls = kCharTable[src[i]];
+        if (cls > kSpace) {
+            dst[i] = static_cast<char>(cls);
+        } else {
+            dst[i] = 0;
+            masks.space |= static_cast<uint64_t>(cls == kSpace) << i;
+            masks.other |= static_cast<uint64_t>(cls != kSpace) << i;
+            masks.high |= static_cast<uint64_t>(src[i] >= 0x80) << i;
+        }
+    }
+    return masks;
+}
+
+#ifdef SEGW_TOKENIZER_X86
+
+// Диапазоны проверяются одним знаковым сравнением: байт сдвигается так,
+// чтобы начало диапазона попало в -128, после чего x < -128 + длина
+__attribute__((target("sse2")))
+Tokenizer::BlockMasks Tokenizer::classifySse2(const unsigned char* src, size_t size, char* dst) {
+    if (size != kBlockSize) {
+        return classifyScalar(src, size, dst);
+    }
+    const __m128i upperShift = _mm_set1_epi8(static_cast<char>(0x80 - 'A'));
+    const __m128i lowerShift = _mm_set1_epi8(static_cast<char>(0x80 - 'a'));
+    const __m128i ctrlShift = _mm_set1_epi8(static_cast<char>(0x80 - '\t'));
+    const __m128i letterLimit = _mm_set1_epi8(static_cast<char>(0x80 + 26));
+    const __m128i ctrlLimit = _mm_set1_epi8(static_cast<char>(0x80 + 5));
+    const __m128i blank = _mm_set1_epi8(' ');
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+
+    BlockMasks masks{0, 0, 0};
+    for (size_t i = 0; i < kBlockSize; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i upper = _mm_cmplt_epi8(_mm_add_epi8(v, upperShift), letterLimit);
+        const __m128i lower = _mm_cmplt_epi8(_mm_add_epi8(v, lowerShift), letterLimit);
+        const __m128i space = _mm_or_si128(
+            _mm_cmpeq_epi8(v, blank),
+            _mm_cmplt_epi8(_mm_add_epi8(v, ctrlShift), ctrlLimit));
+        const __m128i letter = _mm_or_si128(upper, lower);
+        const __m128i folded = _mm_or_si128(v, _mm_and_si128(upper, caseBit));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_and_si128(folded, letter));
+
+        const uint64_t spaceBits = static_cast<uint16_t>(_mm_movemask_epi8(space));
+        const uint64_t letterBits = static_cast<uint16_t>(_mm_movemask_epi8(letter));
+        masks.space |= spaceBits << i;
+        masks.other |= (~(spaceBits | letterBits) & 0xFFFF) << i;
+        masks.high |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(v))) << i;
+    }
+    return masks;
+}
+
+__attribute__((target("avx2")))
+Tokenizer::BlockMasks Tokenizer::classifyAvx2(const unsigned char* src, size_t size, char* dst) {
+    if (size != kBlockSize) {
+        return classifyScalar(src, size, dst);
+    }
+    const __m256i upperShift = _mm256_set1_epi8(static_cast<char>(0x80 - 'A'));
+    const __m256i lowerShift = _mm256_set1_epi8(static_cast<char>(0x80 - 'a'));
+    const __m256i ctrlShift = _mm256_set1_epi8(static_cast<char>(0x80 - '\t'));
+    const __m256i letterLimit = _mm256_set1_epi8(static_cast<char>(0x80 + 26));
+    const __m256i ctrlLimit = _mm256_set1_epi8(static_cast<char>(0x80 + 5));
+    const __m256i blank = _mm256_set1_epi8(' ');
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+
+    BlockMasks masks{0, 0, 0};
+    for (size_t i = 0; i < kBlockSize; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i upper = _mm256_cmpgt_epi8(letterLimit, _mm256_add_epi8(v, upperShift));
+        const __m256i lower = _mm256_cmpgt_epi8(letterLimit, _mm256_add_epi8(v, lowerShift));
+        const __m256i space = _mm256_or_si256(
+            _mm256_cmpeq_epi8(v, blank),
+            _mm256_cmpgt_epi8(ctrlLimit, _mm256_add_epi8(v, ctrlShift)));
+        const __m256i letter = _mm256_or_si256(upper, lower);
+        const __m256i folded = _mm256_or_si256(v, _mm256_and_si256(upper, caseBit));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_and_si256(folded, letter));
+
+        const uint64_t spaceBits = static_cast<uint32_t>(_mm256_movemask_epi8(space));
+        const uint64_t letterBits = static_cast<uint32_t>(_mm256_movemask_epi8(letter));
+        masks.space |= spaceBits << i;
+        masks.other |= (~(spaceBits | letterBits) & 0xFFFFFFFFu) << i;
+        masks.high |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(v))) << i;
+    }
+    return masks;
+}
+
+#endif
+
+bool Tokenizer::IsSupported(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Auto:
+    case Kernel::Scalar:
+        return true;
+#ifdef SEGW_TOKENIZER_X86
+    case Kernel::Sse2:
+        return __builtin_cpu_supports("sse2");
+    case Kernel::Avx2:
+        return __builtin_cpu_supports("avx2");
+#else
+    default:
+        return false;
+#endif
+    }
+    return false;
+}
+
+Tokenizer::ClassifyFn Tokenizer::resolveKernel(Kernel& kernel) {
+    if (kernel == Kernel::Auto) {
+        kernel = IsSupported(Kernel::Avx2) ? Kernel::Avx2
+               : IsSupported(Kernel::Sse2) ? Kernel::Sse2
+               : Kernel::Scalar;
+    } else if (!IsSupported(kernel)) {
+        kernel = Kernel::Scalar;
+    }
+
+    switch (kernel) {
+#ifdef SEGW_TOKENIZER_X86
+    case Kernel::Sse2:
+        return &Tokenizer::classifySse2;
+    case Kernel::Avx2:
+        return &Tokenizer::classifyAvx2;
+#endif
+    default:
+        return &Tokenizer::classifyScalar;
+    }
+}
+
+Tokenizer::Tokenizer(Kernel kernel)
+    : kernel_(kernel),
+      classify_(resolveKernel(kernel_)) {
+}
+
+Tokenizer::BlockMasks Tokenizer::classifyUtf8(std::string_view text, size_t block,
+                                              size_t size, size_t& sequence) {
+    const auto* src = reinterpret_cast<const unsigned char*>(text.data());
+    char* const dst = buffer_.data();
+    const size_t blockEnd = block + size;
+
+    BlockMasks masks{0, 0, 0};
+    size_t pos = std::min(sequence, block);
+    while (pos < blockEnd) {
+        const unsigned char c = src[pos];
+        size_t length = 1;
+        bool letter = false;
+
+        if (c < 0x80) {
+            const uint8_t cls = kCharTable[c];
+            letter = cls > kSpace;
+            dst[pos] = letter ? static_cast<char>(cls) : 0;
+            if (cls == kSpace) {
+                masks.space |= uint64_t{1} << (pos - block);
+                ++pos;
+                continue;
+            }
+        } else {
+            char32_t codePoint = 0;
+            size_t decoded = 0;
+            // Двухбайтовые последовательности (латиница и кириллица) разбираются
+            // напрямую, остальные — автоматом Utf8::Decode
+            if (c >= 0xC2 && c < 0xE0 && pos + 1 < text.size() && (src[pos + 1] & 0xC0) == 0x80) {
+                codePoint = (static_cast<char32_t>(c & 0x1F) << 6) | (src[pos + 1] & 0x3F);
+                decoded = 2;
+            } else {
+                decoded = Utf8::Decode(src + pos, text.size() - pos, codePoint);
+            }
+            const char32_t folded = decoded != 0 ? Utf8::FoldLetter(codePoint) : 0;
+            if (decoded != 0) {
+                length = decoded;
+            }
+            letter = folded != 0;
+            if (letter) {
+                // Буквы таблицы кодируются двумя байтами, и строчная форма тоже
+                dst[pos] = static_cast<char>(0xC0 | (folded >> 6));
+                dst[pos + 1] = static_cast<char>(0x80 | (folded & 0x3F));
+            } else {
+                std::fill(dst + pos, dst + pos + length, 0);
+            }
+        }
+
+        if (!letter) {
+            const size_t from = std::max(pos, block) - block;
+            const size_t to = std::min(pos + length, blockEnd) - block;
+            const uint64_t width = to - from;
+            masks.other |= (width >= 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1) << from;
+        }
+        sequence = pos;
+        pos += length;
+    }
+    // Последовательность, переходящая в следующий блок, будет разобрана им повторно
+    if (pos == blockEnd) {
+        sequence = blockEnd;
+    }
+    return masks;
+}
+
+void Tokenizer::emitWord(size_t begin, size_t end, bool hasOther) {
+    char* const base = buffer_.data();
+    size_t length = end - begin;
+    if (hasOther) {
+        // Отбрасываемые символы записаны нулями: сжимаем слово на месте
+        char* out = base + begin;
+        for (size_t i = begin; i < end; ++i) {
+            if (base[i] != 0) {
+                *out++ = base[i];
+            }
+        }
+        length = static_cast<size_t>(out - (base + begin));
+    }
+    if (length != 0) {
+        tokens_.emplace_back(base + begin, length);
+    }
+}
+
+const std::vector<std::string_view>& Tokenizer::Tokenize(std::string_view text) {
+    tokens_.clear();
+
+    // Буфер выровнен с текстом байт в байт, поэтому
+    // не перераспределяется, пока на него указывают слова
+    if (buffer_.size() < text.size()) {
+        buffer_.resize(text.size());
+    }
+
+    const auto* src = reinterpret_cast<const unsigned char*>(text.data());
+    char* const dst = buffer_.data();
+
+    size_t wordBegin = 0;
+    bool inWord = false;
+    bool hasOther = false;
+    size_t sequence = 0;
+
+    for (size_t block = 0; block < text.size(); block += kBlockSize) {
+        const size_t size = std::min(kBlockSize, text.size() - block);
+        const uint64_t valid = size == kBlockSize ? ~uint64_t{0} : (uint64_t{1} << size) - 1;
+        BlockMasks masks = classify_(src + block, size, dst + block);
+        if (masks.high != 0) {
+            masks = classifyUtf8(text, block, size, sequence);
+        } else {
+            sequence = block + size;
+        }
+
+        // Переходы между словами и разделителями: бит слова отличается от предыдущего
+        const uint64_t word = ~masks.space & valid;
+        const uint64_t shifted = (word << 1) | static_cast<uint64_t>(inWord);
+        uint64_t edges = (word ^ shifted) & valid;
+
+        while (edges != 0) {
+            const size_t bit = static_cast<size_t>(__builtin_ctzll(edges));
+            edges &= edges - 1;
+            if (!inWord) {
+                wordBegin = block + bit;
+                hasOther = false;
+                inWord = true;
+            } else {
+                const size_t from = wordBegin > block ? wordBegin - block : 0;
+                hasOther |= bitRange(masks.other, from, bit) != 0;
+                emitWord(wordBegin, block + bit, hasOther);
+                inWord = false;
+            }
+        }
+        if (inWord) {
+            const size_t from = wordBegin > block ? wordBegin - block : 0;
+            hasOther |= bitRange(masks.other, from, size) != 0;
+        }
+    }
+    if (inWord) {
+        emitWord(wordBegin, text.size(), hasOther);
+    }
+
+    return tokens_;
+}
@@ -0,0 +1,339 @@
+#include "UringReader.h"
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef SEGW_HAVE_IO_URING
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// Длина одного IORING_OP_READ ограничена 32 битами; остаток дочитывается pread
+constexpr size_t kMaxReadChunk = size_t(1) << 30;
+
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+// Дескрипторы файлов пакета: все, что не закрыто через кольцо
+// (например, после исключения из SubmitAndWait), закрывается в деструкторе
+struct BatchFiles {
+    std::vector<int> fds;
+
+    explicit BatchFiles(size_t count) : fds(count, -1) {}
+    ~BatchFiles() {
+        for (int fd : fds) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+
+    BatchFiles(const BatchFiles&) = delete;
+    BatchFiles& operator=(const BatchFiles&) = delete;
+};
+
+} // namespace
+
+// Отображенные в память кольца отправки (SQ) и завершения (CQ)
+struct UringReader::Ring {
+    int fd = -1;
+    unsigned entries = 0;
+
+    void* sqMap = nullptr;
+    size_t sqMapSize = 0;
+    void* cqMap = nullptr;
+    size_t cqMapSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    unsigned pending = 0;
+
+    explicit Ring(unsigned queueDepth) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd = ioUringSetup(queueDepth, &params);
+        if (fd < 0) {
+            throw std::runtime_error("io_uring_setup failed: " + std::string(std::strerror(errno)));
+        }
+        entries = params.sq_entries;
+
+        sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            sqMapSize = cqMapSize = std::max(sqMapSize, cqMapSize);
+        }
+
+        sqMap = ::mmap(nullptr, sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       fd, IORING_OFF_SQ_RING);
+        if (sqMap == MAP_FAILED) {
+            sqMap = nullptr;
+            release();
+            throw std::runtime_error("Cannot map io_uring submission ring");
+        }
+        if (singleMap) {
+            cqMap = sqMap;
+        } else {
+            cqMap = ::mmap(nullptr, cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           fd, IORING_OFF_CQ_RING);
+            if (cqMap == MAP_FAILED) {
+                cqMap = nullptr;
+                release();
+                throw std::runtime_error("Cannot map io_uring completion ring");
+            }
+        }
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqesMap = ::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                               fd, IORING_OFF_SQES);
+        if (sqesMap == MAP_FAILED) {
+            release();
+            throw std::runtime_error("Cannot map io_uring submission entries");
+        }
+        sqes = static_cast<io_uring_sqe*>(sqesMap);
+
+        auto* sq = static_cast<uint8_t*>(sqMap);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        auto* cq = static_cast<uint8_t*>(cqMap);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    ~Ring() {
+        release();
+    }
+
+    void release() {
+        if (sqes) {
+            ::munmap(sqes, sqesSize);
+            sqes = nullptr;
+        }
+        if (cqMap && cqMap != sqMap) {
+            ::munmap(cqMap, cqMapSize);
+        }
+        cqMap = nullptr;
+        if (sqMap) {
+            ::munmap(sqMap, sqMapSize);
+            sqMap = nullptr;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    // Очередная запись отправки; видна ядру после Submit
+    io_uring_sqe* Next(uint64_t userData) {
+        const unsigned tail = *sqTail + pending;
+        const unsigned index = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->user_data = userData;
+        sqArray[index] = index;
+        ++pending;
+        return sqe;
+    }
+
+    // Отправка накопленных записей и ожидание всех завершений;
+    // handler(user_data, res) вызывается для каждого завершения
+    template <typename Handler>
+    void SubmitAndWait(Handler&& handler) {
+        const unsigned count = pending;
+        if (count == 0) {
+            return;
+        }
+        __atomic_store_n(sqTail, *sqTail + count, __ATOMIC_RELEASE);
+        pending = 0;
+
+        unsigned completed = 0;
+        unsigned submitted = 0;
+        while (completed < count) {
+            const unsigned toSubmit = submitted < count ? count - submitted : 0;
+            const int result = ioUringEnter(fd, toSubmit, 1, IORING_ENTER_GETEVENTS);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("io_uring_enter failed: " + std::string(std::strerror(errno)));
+            }
+            submitted += static_cast<unsigned>(result);
+
+            unsigned head = *cqHead;
+            const unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = cqes[head & *cqMask];
+                handler(cqe.user_data, cqe.res);
+                ++completed;
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        }
+    }
+};
+
+bool UringReader::IsAvailable() {
+    static const bool available = []() {
+        try {
+            UringReader probe(1);
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }();
+    return available;
+}
+
+UringReader::UringReader(unsigned queueDepth) : ring(std::make_unique<Ring>(queueDepth)) {}
+
+UringReader::~UringReader() = default;
+
+void UringReader::ReadFiles(const std::vector<std::string>& paths,
+                            std::vector<std::string>& contents, std::vector<bool>& loaded) {
+    contents.assign(paths.size(), std::string());
+    loaded.assign(paths.size(), false);
+
+    // statx и openat занимают по записи на файл, поэтому пакет — половина очереди
+    const size_t batch = std::max<size_t>(1, ring->entries / 2);
+    for (size_t begin = 0; begin < paths.size(); begin += batch) {
+        readBatch(paths, begin, std::min(paths.size(), begin + batch), contents, loaded);
+    }
+}
+
+void UringReader::readBatch(const std::vector<std::string>& paths, size_t begin, size_t end,
+                            std::vector<std::string>& contents, std::vector<bool>& loaded) {
+    const size_t count = end - begin;
+    std::vector<struct statx> stats(count);
+    BatchFiles files(count);
+    std::vector<int>& fds = files.fds;
+    std::vector<bool> statOk(count, false);
+
+    // Этап 1: размер и открытие. user_data = 2 * i (statx) или 2 * i + 1 (openat)
+    for (size_t i = 0; i < count; ++i) {
+        io_uring_sqe* stat = ring->Next(2 * i);
+        stat->opcode = IORING_OP_STATX;
+        stat->fd = AT_FDCWD;
+        stat->addr = reinterpret_cast<uint64_t>(paths[begin + i].c_str());
+        stat->len = STATX_SIZE;
+        stat->off = reinterpret_cast<uint64_t>(&stats[i]);
+
+        io_uring_sqe* open = ring->Next(2 * i + 1);
+        open->opcode = IORING_OP_OPENAT;
+        open->fd = AT_FDCWD;
+        open->addr = reinterpret_cast<uint64_t>(paths[begin + i].c_str());
+        open->open_flags = O_RDONLY | O_CLOEXEC;
+    }
+    ring->SubmitAndWait([&](uint64_t userData, int result) {
+        const size_t i = userData / 2;
+        if (userData % 2 == 0) {
+            statOk[i] = result == 0;
+        } else if (result >= 0) {
+            fds[i] = result;
+        }
+    });
+
+    // Этап 2: чтение каждого открытого файла одним запросом
+    for (size_t i = 0; i < count; ++i) {
+        if (fds[i] < 0 || !statOk[i]) {
+            continue;
+        }
+        std::string& content = contents[begin + i];
+        content.resize(static_cast<size_t>(stats[i].stx_size));
+        if (content.empty()) {
+            loaded[begin + i] = true;
+            continue;
+        }
+        io_uring_sqe* read = ring->Next(i);
+        read->opcode = IORING_OP_READ;
+        read->fd = fds[i];
+        read->addr = reinterpret_cast<uint64_t>(content.data());
+        read->len = static_cast<uint32_t>(std::min<size_t>(content.size(), kMaxReadChunk));
+        read->off = 0;
+    }
+    std::vector<int> readResults(count, 0);
+    ring->SubmitAndWait([&](uint64_t userData, int result) {
+        readResults[userData] = result;
+    });
+
+    for (size_t i = 0; i < count; ++i) {
+        std::string& content = contents[begin + i];
+        if (fds[i] < 0 || !statOk[i] || content.empty()) {
+            continue;
+        }
+        if (readResults[i] < 0) {
+            content.clear();
+            continue;
+        }
+        // Короткое чтение (файл больше kMaxReadChunk или изменился): дочитываем обычным read
+        size_t total = static_cast<size_t>(readResults[i]);
+        while (total < content.size()) {
+            const ssize_t got = ::pread(fds[i], content.data() + total, content.size() - total,
+                                        static_cast<off_t>(total));
+            if (got <= 0) {
+                break;
+            }
+            total += static_cast<size_t>(got);
+        }
+        content.resize(total);
+        loaded[begin + i] = true;
+    }
+
+    // Этап 3: закрытие
+    for (size_t i = 0; i < count; ++i) {
+        if (fds[i] >= 0) {
+            io_uring_sqe* close = ring->Next(i);
+            close->opcode = IORING_OP_CLOSE;
+            close->fd = fds[i];
+        }
+    }
+    // Дескриптор освобождается и при ошибке close, поэтому повторно не закрывается
+    ring->SubmitAndWait([&fds](uint64_t userData, int) {
+        fds[userData] = -1;
+    });
+}
+
+#else
+
+struct UringReader::Ring {};
+
+bool UringReader::IsAvailable() {
+    return false;
+}
+
+UringReader::UringReader(unsigned) {
+    throw std::runtime_error("io_uring support is not compiled in");
+}
+
+UringReader::~UringReader() = default;
+
+void UringReader::ReadFiles(const std::vector<std::string>&, std::vector<std::string>&,
+                            std::vector<bool>&) {
+    throw std::runtime_error("io_uring support is not compiled in");
+}
+
+void UringReader::readBatch(const std::vector<std::string>&, size_t, size_t,
+                            std::vector<std::string>&, std::vector<bool>&) {}
+
+#endif
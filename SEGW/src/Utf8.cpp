@@ -0,0 +1,68 @@
+#include "Utf8.h"
+
+#include <cstring>
+
+namespace Utf8 {
+
+namespace {
+
+inline uint8_t step(uint8_t state, unsigned char byte) {
+    return kTransition[state * kClassCount + kByteClass[byte]];
+}
+
+} // namespace
+
+size_t Decode(const unsigned char* data, size_t available, char32_t& codePoint) {
+    if (available == 0) {
+        return 0;
+    }
+    const unsigned char lead = data[0];
+    uint8_t state = step(kAccept, lead);
+    if (state == kAccept) {
+        codePoint = lead;
+        return 1;
+    }
+    if (state == kReject) {
+        return 0;
+    }
+
+    // Значащие биты ведущего байта: 110xxxxx, 1110xxxx, 11110xxx
+    char32_t value = lead & (lead >= 0xF0 ? 0x07 : lead >= 0xE0 ? 0x0F : 0x1F);
+    for (size_t i = 1; i < available; ++i) {
+        state = step(state, data[i]);
+        if (state == kReject) {
+            return 0;
+        }
+        value = (value << 6) | (data[i] & 0x3F);
+        if (state == kAccept) {
+            codePoint = value;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+bool IsValid(std::string_view text) {
+    const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+    const size_t size = text.size();
+    uint8_t state = kAccept;
+    size_t i = 0;
+
+    while (i < size) {
+        if (state == kAccept && size - i >= 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, data + i, sizeof(chunk));
+            if ((chunk & 0x8080808080808080ull) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+        state = step(state, data[i++]);
+        if (state == kReject) {
+            return false;
+        }
+    }
+    return state == kAccept;
+}
+
+} // namespace Utf8
@@ -1,8 +1,46 @@
 #include <iostream>
 #include <chrono>
+#include <filesystem>
+#include <optional>
+#include <unistd.h>
+#include "AnswersWriter.h"
 #include "ConverterJSON.h"
+#include "IndexPipeline.h"
+#include "IndexSegment.h"
 #include "InvertedIndex.h"
 #include "SearchServer.h"
+#include "SpimiBuilder.h"
+#include "UringReader.h"
+
+// Готовый сегмент используется, только если он цел и построен по тем же документам,
+// которые с тех пор не менялись. Иначе возвращается nullptr и индекс строится заново
+static std::unique_ptr<IndexSegment> openCurrentSegment(const std::string& path,
+                                                        const ConverterJSON& converter) {
+    std::unique_ptr<IndexSegment> segment;
+    try {
+        segment = IndexSegment::Open(path);
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: " << e.what() << ", rebuilding index" << std::endl;
+        return nullptr;
+    }
+
+    const std::vector<std::string>& sources = converter.GetFilePaths();
+    const std::vector<std::string>& resolved = converter.GetResolvedPaths();
+    std::error_code error;
+    const auto segmentTime = std::filesystem::last_write_time(path, error);
+    bool current = !error && segment->DocumentCount() == sources.size();
+    for (size_t docId = 0; current && docId < sources.size(); ++docId) {
+        current = segment->DocumentSource(docId) == sources[docId];
+        if (current && docId < resolved.size() && !resolved[docId].empty()) {
+            current = std::filesystem::last_write_time(resolved[docId], error) <= segmentTime && !error;
+        }
+    }
+    if (!current) {
+        std::cout << "Index segment " << path << " is out of date, rebuilding index" << std::endl;
+        return nullptr;
+    }
+    return segment;
+}
 
 int main() {
     try {
@@ -17,21 +55,83 @@ int main() {
         std::cout << "Application: " << converter.GetAppName() 
                   << " v" << converter.GetVersion() << std::endl;
         
-        // Загрузка документов
-        std::cout << "\n2. Loading documents..." << std::endl;
-        std::vector<std::string> documents = converter.GetTextDocuments();
+        InvertedIndex index(converter.GetThreadPoolSize());
+        index.SetCompression(converter.GetCompressPostings());
+        
+        const std::string segmentPath = converter.GetIndexSegmentPath();
+        auto indexStartTime = std::chrono::high_resolution_clock::now();
         
-        if (documents.empty()) {
-            std::cerr << "Error: No documents loaded for indexing!" << std::endl;
-            return 1;
+        std::unique_ptr<IndexSegment> segment;
+        if (!segmentPath.empty() && std::filesystem::exists(segmentPath)) {
+            segment = openCurrentSegment(segmentPath, converter);
         }
         
-        // Создание и обновление инвертированного индекса (с многопоточностью)
-        std::cout << "\n3. Building inverted index..." << std::endl;
-        InvertedIndex index;
+        if (segment) {
+            // Готовый сегмент индекса: документы не перечитываются
+            std::cout << "\n2-3. Loading index segment " << segmentPath << "..." << std::endl;
+            index.LoadSegment(std::move(segment));
+        } else {
+            const std::vector<std::string>& sources = converter.GetFilePaths();
+            if (sources.empty()) {
+                std::cerr << "Error: No documents loaded for indexing!" << std::endl;
+                return 1;
+            }
+
+            // Чтение, токенизация и построение индекса идут одновременно:
+            // документы проходят через конвейер и сразу освобождаются
+            IndexPipeline pipeline(converter.GetThreadPoolSize(), 64, converter.GetLoaderThreads());
+            // С io_uring читатель забирает пакет файлов на одно кольцо,
+            // с потоками — по одному файлу, чтобы равномерно делить работу
+            const size_t readBatch = converter.GetIoBackend() == "io_uring"
+                ? UringReader::kDefaultQueueDepth / 2 : 1;
+            auto readDocuments = [&converter](size_t begin, size_t end, std::vector<std::string>& texts) {
+                converter.ReadDocuments(begin, end, texts);
+            };
+
+            const size_t memoryBudgetMb = converter.GetIndexMemoryBudgetMb();
+            if (memoryBudgetMb > 0) {
+                // Построение в ограниченной памяти: промежуточные run-файлы
+                // сливаются в сегмент, который затем отображается в память
+                std::cout << "\n2-3. Loading documents and building inverted index (memory budget "
+                          << memoryBudgetMb << " MB)..." << std::endl;
+                const std::string buildPath = segmentPath.empty()
+                    ? (std::filesystem::temp_directory_path() /
+                       ("segw-" + std::to_string(::getpid()) + ".seg")).string()
+                    : segmentPath;
+
+                SpimiBuilder builder(buildPath, memoryBudgetMb * 1024 * 1024,
+                                     converter.GetCompressPostings());
+                pipeline.RunBatched(sources.size(), readDocuments,
+                             [&builder, &sources](size_t docId, DocumentTerms& terms) {
+                                 builder.AddDocument(terms, sources[docId]);
+                             }, readBatch);
+                builder.Finish();
+                std::cout << "Merged " << builder.RunCount() << " index runs" << std::endl;
+
+                index.LoadSegment(buildPath);
+                if (segmentPath.empty()) {
+                    // Отображение остается действительным и после удаления файла
+                    std::filesystem::remove(buildPath);
+                } else {
+                    std::cout << "Index segment saved to " << segmentPath << std::endl;
+                }
+            } else {
+                std::cout << "\n2-3. Loading documents and building inverted index..." << std::endl;
+                // Стадия построения разделена на шарды, которые затем сливаются
+                const size_t shardCount = index.BeginDocumentBase(sources.size());
+                pipeline.RunSharded(sources.size(), readDocuments,
+                             [&index, &sources](size_t shard, size_t docId, DocumentTerms& terms) {
+                                 index.AddDocument(shard, docId, terms, sources[docId]);
+                             }, readBatch, shardCount);
+                index.FinishDocumentBase();
+
+                if (!segmentPath.empty()) {
+                    index.SaveSegment(segmentPath);
+                    std::cout << "Index segment saved to " << segmentPath << std::endl;
+                }
+            }
+        }
         
-        auto indexStartTime = std::chrono::high_resolution_clock::now();
-        index.UpdateDocumentBase(documents);
         auto indexEndTime = std::chrono::high_resolution_clock::now();
         
         auto indexDuration = std::chrono::duration_cast<std::chrono::milliseconds>
@@ -43,47 +143,85 @@ int main() {
         std::cout << "  - Documents: " << stats.totalDocuments << std::endl;
         std::cout << "  - Unique words: " << stats.totalWords << std::endl;
         std::cout << "  - Total entries: " << stats.totalEntries << std::endl;
+        std::cout << "  - Postings memory: " << stats.postingBytes << " bytes" << std::endl;
         std::cout << "  - Indexing time: " << indexDuration.count() << " ms" << std::endl;
         
         // Загрузка поисковых запросов
         std::cout << "\n4. Loading search requests..." << std::endl;
-        std::vector<std::string> requests = converter.GetRequests();
-        
-        if (requests.empty()) {
-            std::cout << "Warning: No search requests found. Creating example request." << std::endl;
-            requests.push_back("example search query");
+        // Недоступный файл запросов не останавливает работу: используется пример запроса
+        std::optional<RequestSource> requestSource;
+        try {
+            requestSource.emplace(converter.OpenRequests());
+        } catch (const std::exception& e) {
+            std::cerr << "Error reading requests: " << e.what() << std::endl;
         }
+        SearchServer searchServer(index, converter.GetThreadPoolSize());
+        std::vector<std::string> requests;
+        std::vector<std::vector<RelativeIndex>> searchResults;
+        SearchServer::SearchStats searchStats;
+        const bool streaming = requestSource && requestSource->IsStreaming();
+        size_t totalResults = 0;
+        size_t successfulQueries = 0;
+        auto searchStartTime = std::chrono::high_resolution_clock::now();
         
-        // Инициализация поискового сервера
-        std::cout << "\n5. Processing search requests..." << std::endl;
-        SearchServer searchServer(index);
+        if (streaming) {
+            // JSON Lines: запросы читаются по мере поиска, а ответы сразу
+            // записываются в файл ответов — ни те, ни другие не копятся в памяти
+            std::cout << "Streaming requests..." << std::endl;
+            std::cout << "\n5-6. Processing search requests and saving results..." << std::endl;
+            AnswersWriter answersWriter = converter.OpenAnswers();
+            searchStartTime = std::chrono::high_resolution_clock::now();
+            searchStats = searchServer.searchStream(
+                [&requestSource](std::string& request) { return requestSource->Next(request); },
+                [&](size_t, std::vector<RelativeIndex>& results) {
+                    if (!results.empty()) {
+                        successfulQueries++;
+                        totalResults += results.size();
+                    }
+                    answersWriter.Add(std::move(results));
+                },
+                converter.GetResponsesLimit());
+            answersWriter.Finish();
+        } else {
+            std::string request;
+            while (requestSource && requestSource->Next(request)) {
+                requests.push_back(std::move(request));
+            }
+            std::cout << "Loaded " << requests.size() << " requests" << std::endl;
+            
+            if (requests.empty()) {
+                std::cout << "Warning: No search requests found. Creating example request." << std::endl;
+                requests.push_back("example search query");
+            }
+            
+            // Инициализация поискового сервера
+            std::cout << "\n5. Processing search requests..." << std::endl;
+            searchStats = searchServer.getSearchStats(requests);
+            
+            // Выполнение поиска с многопоточностью
+            searchStartTime = std::chrono::high_resolution_clock::now();
+            searchResults = searchServer.search(requests, converter.GetResponsesLimit());
+        }
+        auto searchEndTime = std::chrono::high_resolution_clock::now();
         
         // Получение статистики поиска
-        auto searchStats = searchServer.getSearchStats(requests);
         std::cout << "Search statistics:" << std::endl;
         std::cout << "  - Total queries: " << searchStats.totalQueries << std::endl;
         std::cout << "  - Queries with results: " << searchStats.queriesWithResults << std::endl;
         std::cout << "  - Average words per query: " << searchStats.averageWordsPerQuery << std::endl;
         
-        // Выполнение поиска с многопоточностью
-        auto searchStartTime = std::chrono::high_resolution_clock::now();
-        std::vector<std::vector<RelativeIndex>> searchResults = 
-            searchServer.search(requests, converter.GetResponsesLimit());
-        auto searchEndTime = std::chrono::high_resolution_clock::now();
-        
         auto searchDuration = std::chrono::duration_cast<std::chrono::milliseconds>
                              (searchEndTime - searchStartTime);
         
         std::cout << "Search completed in " << searchDuration.count() << " ms" << std::endl;
         
-        // Сохранение результатов
-        std::cout << "\n6. Saving results..." << std::endl;
-        converter.putAnswers(searchResults);
+        if (!streaming) {
+            // Сохранение результатов
+            std::cout << "\n6. Saving results..." << std::endl;
+            converter.putAnswers(searchResults);
+        }
         
         // Вывод краткой информации о результатах
-        size_t totalResults = 0;
-        size_t successfulQueries = 0;
-        
         for (size_t i = 0; i < searchResults.size(); ++i) {
             if (!searchResults[i].empty()) {
                 successfulQueries++;
@@ -103,9 +241,9 @@ int main() {
         
         std::cout << "\n=== Search Engine Summary ===" << std::endl;
         std::cout << "Total execution time: " << totalDuration.count() << " ms" << std::endl;
-        std::cout << "Successful queries: " << successfulQueries << "/" << requests.size() << std::endl;
+        std::cout << "Successful queries: " << successfulQueries << "/" << searchStats.totalQueries << std::endl;
         std::cout << "Total results found: " << totalResults << std::endl;
-        std::cout << "Results saved to JSON/answers.json" << std::endl;
+        std::cout << "Results saved to " << converter.GetAnswersPath() << std::endl;
         std::cout << "\nSearch engine finished successfully!" << std::endl;
         
         return 0;
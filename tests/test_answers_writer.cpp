@@ -0,0 +1,232 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include "../SEGW/include/AnswersWriter.h"
+
+using namespace std;
+
+namespace {
+
+// Прежняя запись через DOM (без ограничения на три цифры в номере запроса)
+nlohmann::json BuildDom(const vector<vector<RelativeIndex>>& answers, size_t maxResponses) {
+    nlohmann::json answersJson = nlohmann::json::object();
+    answersJson["answers"] = nlohmann::json::object();
+    for (size_t i = 0; i < answers.size(); ++i) {
+        string requestId;
+        AnswersWriter::AppendRequestId(requestId, i);
+        nlohmann::json& answer = answersJson["answers"][requestId];
+        answer["result"] = !answers[i].empty();
+        const size_t responseCount = min(answers[i].size(), maxResponses);
+        if (responseCount == 1) {
+            answer["docid"] = answers[i][0].doc_id;
+            answer["rank"] = answers[i][0].rank;
+        } else {
+            for (size_t j = 0; j < responseCount; ++j) {
+                answer["relevance"].push_back({{"docid", answers[i][j].doc_id}, {"rank", answers[i][j].rank}});
+            }
+        }
+    }
+    return answersJson;
+}
+
+string ReadAndRemove(const string& path) {
+    ifstream file(path, ios::binary);
+    stringstream content;
+    content << file.rdbuf();
+    file.close();
+    remove(path.c_str());
+    return content.str();
+}
+
+string Write(const vector<vector<RelativeIndex>>& answers, size_t maxResponses, AnswersWriter::Format format) {
+    const string path = "test_answers_writer.json";
+    {
+        AnswersWriter writer(path, format, maxResponses);
+        for (const auto& answer : answers) {
+            writer.Add(answer);
+        }
+        writer.Finish();
+        EXPECT_EQ(writer.Count(), answers.size());
+    }
+    return ReadAndRemove(path);
+}
+
+} // namespace
+
+TEST(TestCaseAnswersWriter, TestMatchesDomDump) {
+    mt19937 rng(11);
+    uniform_int_distribution<size_t> count(0, 7);
+    uniform_int_distribution<size_t> doc(0, 100000);
+    uniform_int_distribution<int> divisor(1, 1000);
+    vector<vector<RelativeIndex>> answers(300);
+    for (auto& answer : answers) {
+        for (size_t j = count(rng); j > 0; --j) {
+            answer.emplace_back(doc(rng), static_cast<float>(divisor(rng)) / static_cast<float>(divisor(rng) + 1000));
+        }
+    }
+    answers[1] = {RelativeIndex(3, 1.0f)};
+    answers[2] = {RelativeIndex(4, 1.0f), RelativeIndex(5, 1.0f / 3.0f)};
+
+    for (size_t maxResponses : {size_t(0), size_t(1), size_t(5)}) {
+        const nlohmann::json dom = BuildDom(answers, maxResponses);
+        EXPECT_EQ(Write(answers, maxResponses, AnswersWriter::Format::Pretty), dom.dump(4)) << maxResponses;
+        EXPECT_EQ(Write(answers, maxResponses, AnswersWriter::Format::Compact), dom.dump()) << maxResponses;
+    }
+}
+
+TEST(TestCaseAnswersWriter, TestNumberFormatting) {
+    // Крайние значения ранга: целые, малые и большие показатели
+    const vector<float> ranks = {1.0f, 0.5f, 0.1f, 1e-4f, 2e-4f, 1.25e-5f, 3e-10f, 123456.0f,
+                                 1e15f, 1e16f, 3.5e20f, numeric_limits<float>::min(),
+                                 numeric_limits<float>::max(), 0.0f};
+    vector<vector<RelativeIndex>> answers;
+    for (float rank : ranks) {
+        answers.push_back({RelativeIndex(numeric_limits<uint32_t>::max(), rank)});
+    }
+    EXPECT_EQ(Write(answers, 5, AnswersWriter::Format::Compact), BuildDom(answers, 5).dump());
+}
+
+TEST(TestCaseAnswersWriter, TestRanksMatchDumpByteForByte) {
+    // Подряд идущие float от 0.5: среди них много значений, у которых кратчайшая
+    // запись неоднозначна, — на них std::to_chars и dump расходятся в последней цифре
+    vector<vector<RelativeIndex>> answers;
+    for (float rank = 0.5f; answers.size() < (1u << 16); rank = nextafter(rank, 1.0f)) {
+        answers.push_back({RelativeIndex(answers.size(), rank)});
+    }
+    for (int divisor = 1; divisor < 300; ++divisor) {
+        for (int count = 0; count <= divisor; count += 7) {
+            answers.push_back({RelativeIndex(0, static_cast<float>(count) / static_cast<float>(divisor))});
+        }
+    }
+
+    // Пакетами до 999 запросов: в DOM ключи request1000 и дальше сортируются иначе
+    for (size_t begin = 0; begin < answers.size(); begin += 999) {
+        const vector<vector<RelativeIndex>> chunk(answers.begin() + begin,
+                                                  answers.begin() + min(begin + 999, answers.size()));
+        ASSERT_EQ(Write(chunk, 5, AnswersWriter::Format::Pretty), BuildDom(chunk, 5).dump(4)) << begin;
+    }
+}
+
+TEST(TestCaseAnswersWriter, TestRequestIdsAndEmptyOutput) {
+    string id;
+    AnswersWriter::AppendRequestId(id, 0);
+    EXPECT_EQ(id, "request001");
+    id.clear();
+    AnswersWriter::AppendRequestId(id, 998);
+    EXPECT_EQ(id, "request999");
+    id.clear();
+    AnswersWriter::AppendRequestId(id, 999);
+    EXPECT_EQ(id, "request1000");
+
+    // Ответы пишутся по порядку запросов, в том числе после request999
+    vector<vector<RelativeIndex>> answers(1200);
+    const string compact = Write(answers, 5, AnswersWriter::Format::Compact);
+    EXPECT_LT(compact.find("\"request999\""), compact.find("\"request1000\""));
+    EXPECT_EQ(nlohmann::json::parse(compact)["answers"].size(), 1200u);
+
+    EXPECT_EQ(Write({}, 5, AnswersWriter::Format::Pretty), "{\n    \"answers\": {}\n}");
+    EXPECT_EQ(Write({}, 5, AnswersWriter::Format::Compact), "{\"answers\":{}}");
+}
+
+TEST(TestCaseAnswersWriter, TestParallelChunksMatchSerial) {
+    mt19937 rng(3);
+    uniform_int_distribution<size_t> count(0, 6);
+    vector<vector<RelativeIndex>> answers(40000);
+    for (auto& answer : answers) {
+        for (size_t j = count(rng); j > 0; --j) {
+            answer.emplace_back(rng() % 5000, static_cast<float>(rng() % 1000) / 1000.0f);
+        }
+    }
+    const string serial = Write(answers, 5, AnswersWriter::Format::Pretty);
+
+    // Раунды по несколько кусков, в том числе неполные; Add и AddAll вперемешку
+    const string path = "test_answers_parallel.json";
+    {
+        AnswersWriter writer(path, AnswersWriter::Format::Pretty, 5, 4);
+        for (size_t i = 0; i < 20000; ++i) {
+            vector<RelativeIndex> copy = answers[i];
+            writer.Add(move(copy));
+        }
+        writer.AddAll(vector<vector<RelativeIndex>>(answers.begin() + 20000, answers.end() - 7));
+        for (size_t i = answers.size() - 7; i < answers.size(); ++i) {
+            writer.Add(answers[i]);
+        }
+        writer.Finish();
+        EXPECT_EQ(writer.Count(), answers.size());
+    }
+    EXPECT_EQ(ReadAndRemove(path), serial);
+
+    // Незавершенный писатель закрывает документ в деструкторе
+    {
+        AnswersWriter writer(path, AnswersWriter::Format::Compact, 5, 4);
+        writer.Add(answers[1]);
+    }
+    EXPECT_EQ(ReadAndRemove(path), Write({answers[1]}, 5, AnswersWriter::Format::Compact));
+}
+
+TEST(TestCaseAnswersWriter, TestBinaryFormatsRoundTrip) {
+    mt19937 rng(7);
+    uniform_int_distribution<size_t> count(0, 20);
+    vector<vector<RelativeIndex>> answers(1500);
+    for (auto& answer : answers) {
+        for (size_t j = count(rng); j > 0; --j) {
+            answer.emplace_back(rng() % 3000000, static_cast<float>(rng() % 1000) / 999.0f);
+        }
+    }
+    const size_t maxResponses = 17;
+    const nlohmann::json dom = BuildDom(answers, maxResponses);
+
+    for (auto format : {AnswersWriter::Format::Cbor, AnswersWriter::Format::MessagePack}) {
+        for (size_t threads : {size_t(1), size_t(3)}) {
+            const string path = "test_answers_binary.bin";
+            {
+                AnswersWriter writer(path, format, maxResponses, threads);
+                for (const auto& answer : answers) {
+                    writer.Add(answer);
+                }
+                writer.Finish();
+            }
+            // Та же логическая схема, что у JSON; ранги совпадают точно (float32)
+            const string bytes = ReadAndRemove(path);
+            const vector<uint8_t> data(bytes.begin(), bytes.end());
+            const nlohmann::json decoded = format == AnswersWriter::Format::Cbor
+                ? nlohmann::json::from_cbor(data) : nlohmann::json::from_msgpack(data);
+            EXPECT_EQ(decoded, dom);
+            EXPECT_LT(bytes.size() * 3, dom.dump(4).size());
+
+            {
+                AnswersWriter writer(path, format, maxResponses, threads);
+                writer.AddAll(answers);
+            }
+            const vector<vector<RelativeIndex>> read = AnswersWriter::Read(path, format);
+            remove(path.c_str());
+            ASSERT_EQ(read.size(), answers.size());
+            for (size_t i = 0; i < answers.size(); ++i) {
+                const size_t expected = min(answers[i].size(), maxResponses);
+                ASSERT_EQ(read[i].size(), expected) << i;
+                for (size_t j = 0; j < expected; ++j) {
+                    EXPECT_EQ(read[i][j].doc_id, answers[i][j].doc_id);
+                    EXPECT_EQ(read[i][j].rank, answers[i][j].rank);
+                }
+            }
+        }
+    }
+
+    // Пустой набор ответов тоже читается
+    for (auto format : {AnswersWriter::Format::Cbor, AnswersWriter::Format::MessagePack,
+                        AnswersWriter::Format::Compact}) {
+        const string path = "test_answers_empty.bin";
+        AnswersWriter(path, format, 5).Finish();
+        EXPECT_TRUE(AnswersWriter::Read(path, format).empty());
+        remove(path.c_str());
+    }
+    EXPECT_THROW(AnswersWriter::Read("missing_answers.cbor", AnswersWriter::Format::Cbor), runtime_error);
+}
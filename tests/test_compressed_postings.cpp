@@ -0,0 +1,107 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../SEGW/include/CompressedPostings.h"
+#include "../SEGW/include/InvertedIndex.h"
+#include "../SEGW/include/SearchServer.h"
+
+using namespace std;
+
+TEST(TestCaseCompressedPostings, TestRoundTripAcrossBlocks) {
+    vector<Entry> entries;
+    for (size_t i = 0; i < 1000; ++i) {
+        entries.push_back({i * i * 37, 1 + (i * 13) % 500});
+    }
+
+    CompressedPostings store;
+    store.Append({});
+    store.Append(entries);
+
+    ASSERT_EQ(store.ListCount(), 2u);
+    EXPECT_EQ(store.PostingCount(0), 0u);
+    EXPECT_EQ(store.PostingCount(1), entries.size());
+
+    PostingCursor empty = store.Cursor(0);
+    EXPECT_FALSE(empty.Next());
+
+    vector<Entry> decoded;
+    for (PostingCursor cursor = store.Cursor(1); cursor.Next(); ) {
+        ASSERT_LE(cursor.Block().size(), PostingCursor::kBlockSize);
+        decoded.insert(decoded.end(), cursor.Block().begin(), cursor.Block().end());
+    }
+    EXPECT_EQ(decoded, entries);
+}
+
+TEST(TestCaseCompressedPostings, TestCompressedIndexMatchesRaw) {
+    vector<string> docs;
+    for (size_t i = 0; i < 400; ++i) {
+        docs.push_back(i % 3 == 0 ? "milk milk water" : "water tea " + string(i % 5, 'x'));
+    }
+
+    InvertedIndex raw;
+    raw.UpdateDocumentBase(docs);
+    InvertedIndex compressed;
+    compressed.SetCompression(true);
+    compressed.UpdateDocumentBase(docs);
+
+    ASSERT_TRUE(compressed.IsCompressed());
+    for (const auto& word : {"milk", "water", "tea", "xx", "coffee"}) {
+        ASSERT_EQ(raw.GetWordCount(word), compressed.GetWordCount(word)) << word;
+    }
+    EXPECT_EQ(raw.GetStats().totalEntries, compressed.GetStats().totalEntries);
+    EXPECT_LT(compressed.GetStats().postingBytes, raw.GetStats().postingBytes);
+
+    const vector<string> queries = {"milk water", "tea", "xxxx water"};
+    EXPECT_EQ(SearchServer(raw).search(queries), SearchServer(compressed).search(queries));
+}
+
+TEST(TestCaseCompressedPostings, TestTruncatedListThrows) {
+    vector<Entry> entries;
+    for (size_t i = 0; i < 300; ++i) {
+        entries.push_back({i * 1000, 1 + i % 7});
+    }
+    vector<uint8_t> encoded;
+    CompressedPostings::Encode(entries, encoded);
+
+    // Любой непустой обрывок списка дочитывается только до своей границы
+    for (size_t size = 1; size < encoded.size(); ++size) {
+        const vector<uint8_t> truncated(encoded.begin(), encoded.begin() + size);
+        EXPECT_THROW({
+            PostingCursor cursor(truncated.data(), truncated.data() + truncated.size());
+            while (cursor.Next()) {
+            }
+        }, runtime_error) << size;
+    }
+
+    const vector<uint8_t> overlong(11, 0xff);
+    EXPECT_THROW(CompressedPostings::EncodedCount(overlong.data(), overlong.data() + overlong.size()),
+                 runtime_error);
+}
+
+TEST(TestCaseCompressedPostings, TestEncoderAcceptsAnyPortions) {
+    vector<Entry> entries;
+    for (size_t i = 0; i < 1000; ++i) {
+        entries.push_back({i * 3 + i % 2, 1 + i % 11});
+    }
+    vector<uint8_t> expected;
+    CompressedPostings::Encode(entries, expected);
+
+    // Порции не совпадают с границами блоков
+    vector<uint8_t> streamed;
+    PostingEncoder encoder;
+    encoder.Begin(entries.size(), streamed);
+    for (size_t begin = 0, portion = 1; begin < entries.size(); begin += portion, portion = portion * 3 % 257) {
+        const size_t size = min(portion, entries.size() - begin);
+        encoder.Add(PostingsView(entries.data() + begin, size), streamed);
+    }
+    encoder.End(streamed);
+    EXPECT_EQ(streamed, expected);
+
+    vector<uint8_t> overflow;
+    encoder.Begin(1, overflow);
+    EXPECT_THROW(encoder.Add(PostingsView(entries.data(), 2), overflow), logic_error);
+    encoder.Begin(2, overflow);
+    encoder.Add(PostingsView(entries.data(), 1), overflow);
+    EXPECT_THROW(encoder.End(overflow), logic_error);
+}
@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 #include "../SEGW/include/ConverterJSON.h"
+#include "../SEGW/include/UringReader.h"
 #include <fstream>
 #include <filesystem>
+#include <sstream>
 
 class ConverterJSONTest : public ::testing::Test {
 protected:
@@ -289,4 +291,115 @@ TEST_F(ConverterJSONTest, DefaultValues) {
     EXPECT_EQ(converter.GetAppName(), "Minimal Engine");
     EXPECT_EQ(converter.GetVersion(), "0.1");  // Значение по умолчанию
     EXPECT_GT(converter.GetResponsesLimit(), 0);  // Должно быть больше 0
-}
\ No newline at end of file
+}
+
+// Тест параллельной загрузки: порядок документов и прежняя замена переводов строк
+TEST_F(ConverterJSONTest, ParallelLoadKeepsOrderAndLineLayout) {
+    const std::vector<std::string> contents = {
+        "first line\nsecond line\n",
+        "no trailing newline",
+        "",
+        "\n\nblank lines\n",
+        "windows\r\nlines"
+    };
+    nlohmann::json configJson = {
+        {"config", {
+            {"name", "Parallel Engine"},
+            {"loader_threads", 3}
+        }},
+        {"files", nlohmann::json::array()}
+    };
+    for (size_t i = 0; i < 40; ++i) {
+        const std::string path = "test_resources/doc" + std::to_string(i) + ".txt";
+        std::ofstream(path, std::ios::binary) << contents[i % contents.size()];
+        configJson["files"].push_back(path);
+    }
+    std::ofstream("config.json") << configJson.dump(4);
+
+    ConverterJSON converter;
+    EXPECT_EQ(converter.GetLoaderThreads(), 3u);
+    std::vector<std::string> documents = converter.GetTextDocuments();
+    ASSERT_EQ(documents.size(), 40u);
+
+    for (size_t i = 0; i < documents.size(); ++i) {
+        // Ожидаемое содержимое — как при чтении через getline
+        std::istringstream stream(contents[i % contents.size()]);
+        std::string expected;
+        std::string line;
+        while (std::getline(stream, line)) {
+            expected += line + " ";
+        }
+        EXPECT_EQ(documents[i], expected) << i;
+        EXPECT_EQ(converter.ReadDocument(i), expected) << i;
+    }
+}
+
+// Пакетное чтение через io_uring дает те же документы, что и обычное
+TEST_F(ConverterJSONTest, IoUringBackendMatchesThreads) {
+    nlohmann::json configJson = {
+        {"config", {
+            {"name", "Uring Engine"},
+            {"io_backend", "io_uring"}
+        }},
+        {"files", nlohmann::json::array()}
+    };
+    for (size_t i = 0; i < 70; ++i) {
+        const std::string path = "test_resources/uring" + std::to_string(i) + ".txt";
+        std::ofstream(path, std::ios::binary) << "line " << i << "\nnext line " << std::string(i * 100, 'x');
+        configJson["files"].push_back(path);
+    }
+    configJson["files"].push_back("test_resources/missing.txt");
+    std::ofstream("config.json") << configJson.dump(4);
+
+    ConverterJSON converter;
+    if (!UringReader::IsAvailable()) {
+        EXPECT_EQ(converter.GetIoBackend(), "threads");
+        GTEST_SKIP() << "io_uring is not available";
+    }
+    EXPECT_EQ(converter.GetIoBackend(), "io_uring");
+
+    std::vector<std::string> texts(71);
+    converter.ReadDocuments(0, 71, texts);
+    for (size_t i = 0; i < 70; ++i) {
+        EXPECT_EQ(texts[i], converter.ReadDocument(i)) << i;
+        EXPECT_EQ(texts[i], "line " + std::to_string(i) + " next line " + std::string(i * 100, 'x') + " ");
+    }
+    EXPECT_TRUE(texts[70].empty());
+    EXPECT_EQ(converter.GetTextDocuments(), texts);
+}
+
+TEST_F(ConverterJSONTest, UnknownIoBackendThrows) {
+    nlohmann::json configJson = {
+        {"config", {{"name", "Bad Backend"}, {"io_backend", "aio"}}},
+        {"files", {"test_resources/test_file1.txt"}}
+    };
+    std::ofstream("config.json") << configJson.dump(4);
+    EXPECT_THROW(ConverterJSON converter, std::runtime_error);
+}
+
+// Пути документов находятся один раз при загрузке и хранятся абсолютными
+TEST_F(ConverterJSONTest, ResolvesDocumentPathsOnce) {
+    nlohmann::json configJson = {
+        {"config", {{"name", "Resolved Engine"}}},
+        {"files", {"test_resources/test_file1.txt", "test_resources/missing.txt",
+                   "./test_resources/../test_resources/test_file2.txt"}}
+    };
+    std::ofstream("config.json") << configJson.dump(4);
+
+    ConverterJSON converter;
+    const std::vector<std::string>& resolved = converter.GetResolvedPaths();
+    ASSERT_EQ(resolved.size(), 3u);
+    EXPECT_EQ(resolved[0], (std::filesystem::current_path() / "test_resources/test_file1.txt").string());
+    EXPECT_TRUE(resolved[1].empty());
+    EXPECT_EQ(resolved[2], (std::filesystem::current_path() / "test_resources/test_file2.txt").string());
+    EXPECT_GE(converter.GetPathResolutionMs(), 0.0);
+
+    // Чтение не зависит от смены текущего каталога после загрузки
+    const std::filesystem::path cwd = std::filesystem::current_path();
+    std::filesystem::current_path(cwd / "test_resources");
+    const std::string text = converter.ReadDocument(0);
+    const std::string missing = converter.ReadDocument(1);
+    std::filesystem::current_path(cwd);
+    EXPECT_EQ(text, "This is a test document with various words for testing search functionality. ");
+    EXPECT_TRUE(missing.empty());
+}
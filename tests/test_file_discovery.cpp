@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "../SEGW/include/FileDiscovery.h"
+
+using namespace std;
+
+namespace {
+
+// Дерево вида root/dN/sM/... с файлами разных расширений и размеров
+class FileDiscoveryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root = filesystem::temp_directory_path() / ("segw-discovery-" + to_string(::getpid()));
+        filesystem::remove_all(root);
+        for (size_t d = 0; d < 6; ++d) {
+            for (size_t s = 0; s < 4; ++s) {
+                const filesystem::path dir = root / ("d" + to_string(d)) / ("s" + to_string(s)) / "deep";
+                filesystem::create_directories(dir);
+                write(dir.parent_path() / ("doc" + to_string(s) + ".txt"), 10);
+                write(dir / "note.md", 20);
+                write(dir / "image.png", 5);
+            }
+        }
+        write(root / "top.txt", 1);
+        write(root / "big.txt", 4096);
+    }
+
+    void TearDown() override {
+        filesystem::remove_all(root);
+    }
+
+    static void write(const filesystem::path& path, size_t size) {
+        ofstream(path, ios::binary) << string(size, 'a');
+    }
+
+    filesystem::path root;
+};
+
+} // namespace
+
+TEST_F(FileDiscoveryTest, TestRecursiveFilteredAndSorted) {
+    FileDiscovery::Options options;
+    options.extensions = {".txt", ".md"};
+    options.maxFileSize = 1024;
+    options.threads = 4;
+    FileDiscovery discovery(options);
+
+    const vector<string> files = discovery.Discover(root.string());
+    ASSERT_EQ(files.size(), 6u * 4u * 2u + 1u);
+    EXPECT_TRUE(is_sorted(files.begin(), files.end()));
+    EXPECT_EQ(files.front(), "d0/s0/deep/note.md");
+    EXPECT_EQ(files.back(), "top.txt");
+    for (const auto& file : files) {
+        EXPECT_EQ(file.find(".png"), string::npos) << file;
+        EXPECT_TRUE(filesystem::is_regular_file(root / file)) << file;
+    }
+    EXPECT_EQ(discovery.SkippedBySize(), 1u);
+    EXPECT_EQ(discovery.DirectoryCount(), 1u + 6u + 6u * 4u * 2u);
+}
+
+TEST_F(FileDiscoveryTest, TestThreadCountDoesNotChangeResult) {
+    FileDiscovery::Options options;
+    options.threads = 1;
+    const vector<string> serial = FileDiscovery(options).Discover(root.string());
+    options.threads = 8;
+    const vector<string> parallel = FileDiscovery(options).Discover(root.string());
+
+    // Без фильтров находятся все файлы, включая большой и .png
+    EXPECT_EQ(serial.size(), 6u * 4u * 3u + 2u);
+    EXPECT_EQ(serial, parallel);
+}
+
+TEST_F(FileDiscoveryTest, TestWalkStreamsBatchesAndRejectsFiles) {
+    FileDiscovery::Options options;
+    options.extensions = {".md"};
+    size_t batches = 0;
+    size_t files = 0;
+    FileDiscovery(options).Walk(root.string(), [&](vector<string>& batch) {
+        ++batches;
+        files += batch.size();
+    });
+    EXPECT_EQ(files, 6u * 4u);
+    EXPECT_EQ(batches, 6u * 4u);
+
+    EXPECT_THROW(FileDiscovery(options).Discover((root / "top.txt").string()), runtime_error);
+    EXPECT_THROW(FileDiscovery(options).Discover((root / "missing").string()), runtime_error);
+}
@@ -0,0 +1,216 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../SEGW/include/BoundedQueue.h"
+#include "../SEGW/include/IndexPipeline.h"
+#include "../SEGW/include/InvertedIndex.h"
+
+using namespace std;
+
+TEST(TestCaseIndexPipeline, TestQueueDeliversEveryItemOnce) {
+    BoundedQueue<size_t> queue(8);
+    const size_t kProducers = 3;
+    const size_t kPerProducer = 20000;
+    atomic<size_t> sum{0};
+    atomic<size_t> received{0};
+
+    vector<thread> consumers;
+    for (size_t i = 0; i < 3; ++i) {
+        consumers.emplace_back([&]() {
+            size_t value = 0;
+            while (queue.Pop(value)) {
+                sum += value;
+                ++received;
+            }
+        });
+    }
+    vector<thread> producers;
+    for (size_t p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p]() {
+            for (size_t i = 1; i <= kPerProducer; ++i) {
+                queue.Push(p * kPerProducer + i);
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    queue.Close();
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+
+    const size_t total = kProducers * kPerProducer;
+    EXPECT_EQ(received.load(), total);
+    EXPECT_EQ(sum.load(), total * (total + 1) / 2);
+    EXPECT_FALSE(queue.Push(1));
+}
+
+TEST(TestCaseIndexPipeline, TestPipelineMatchesBatchBuild) {
+    vector<string> docs;
+    for (size_t i = 0; i < 300; ++i) {
+        docs.push_back("milk water doc" + to_string(i % 17) + " Milk tea" + string(i % 5, 'a'));
+    }
+
+    InvertedIndex expected;
+    expected.UpdateDocumentBase(docs);
+
+    InvertedIndex streamed;
+    IndexPipeline pipeline(4, 2);
+    size_t nextDocId = 0;
+    pipeline.Run(docs.size(),
+                 [&docs](size_t docId) { return docs[docId]; },
+                 [&](size_t docId, DocumentTerms& terms) {
+                     ASSERT_EQ(docId, nextDocId++);
+                     streamed.AddDocument(terms, "doc" + to_string(docId));
+                 });
+    streamed.FinishDocumentBase();
+
+    EXPECT_EQ(streamed.GetDocumentCount(), docs.size());
+    EXPECT_EQ(streamed.GetStats().totalEntries, expected.GetStats().totalEntries);
+    EXPECT_EQ(streamed.GetDocumentInfo(42).tokenCount, expected.GetDocumentInfo(42).tokenCount);
+    EXPECT_EQ(streamed.GetDocumentInfo(42).source, "doc42");
+    for (const string word : {"milk", "water", "tea", "doc3", "teaaaa", "doc16"}) {
+        EXPECT_EQ(streamed.GetWordCount(word), expected.GetWordCount(word)) << word;
+    }
+}
+
+TEST(TestCaseIndexPipeline, TestShardedBuildMatchesBatchBuild) {
+    vector<string> docs;
+    for (size_t i = 0; i < 500; ++i) {
+        docs.push_back("milk water doc" + to_string(i % 17) + " Milk tea" + string(i % 5, 'a'));
+    }
+
+    InvertedIndex expected;
+    expected.UpdateDocumentBase(docs);
+
+    // Шарды получают чередующиеся doc_id, слияние восстанавливает порядок списков
+    InvertedIndex streamed(4);
+    const size_t shardCount = streamed.BeginDocumentBase(docs.size());
+    ASSERT_EQ(shardCount, 4u);
+    vector<size_t> nextDocId(shardCount);
+    for (size_t shard = 0; shard < shardCount; ++shard) {
+        nextDocId[shard] = shard;
+    }
+    IndexPipeline pipeline(3, 4);
+    pipeline.RunSharded(docs.size(),
+                        [&docs](size_t begin, size_t, vector<string>& texts) { texts[0] = docs[begin]; },
+                        [&](size_t shard, size_t docId, DocumentTerms& terms) {
+                            ASSERT_EQ(docId, nextDocId[shard]);
+                            nextDocId[shard] += shardCount;
+                            streamed.AddDocument(shard, docId, terms, "doc" + to_string(docId));
+                        },
+                        1, shardCount);
+    streamed.FinishDocumentBase();
+
+    EXPECT_EQ(streamed.GetDocumentCount(), docs.size());
+    EXPECT_EQ(streamed.GetStats().totalWords, expected.GetStats().totalWords);
+    EXPECT_EQ(streamed.GetStats().totalEntries, expected.GetStats().totalEntries);
+    EXPECT_EQ(streamed.GetDocumentInfo(42).tokenCount, expected.GetDocumentInfo(42).tokenCount);
+    EXPECT_EQ(streamed.GetDocumentInfo(499).source, "doc499");
+    for (const string word : {"milk", "water", "tea", "doc3", "teaaaa", "doc16"}) {
+        EXPECT_EQ(streamed.GetWordCount(word), expected.GetWordCount(word)) << word;
+    }
+}
+
+TEST(TestCaseIndexPipeline, TestBatchedReadersKeepDocumentOrder) {
+    // Цифры не входят в слова, поэтому номер документа кодируется буквами
+    auto letters = [](size_t id) {
+        string word = "x";
+        for (; id > 0; id /= 26) {
+            word.push_back(static_cast<char>('a' + id % 26));
+        }
+        return word;
+    };
+    vector<string> docs;
+    for (size_t i = 0; i < 203; ++i) {
+        docs.push_back("batch " + letters(i));
+    }
+
+    // Пакеты не пересекаются и покрывают все doc_id; последний пакет неполный
+    IndexPipeline pipeline(3, 4, 3);
+    vector<size_t> batchSizes(docs.size(), 0);
+    size_t nextDocId = 0;
+    pipeline.RunBatched(docs.size(),
+                        [&](size_t begin, size_t end, vector<string>& texts) {
+                            ASSERT_EQ(texts.size(), end - begin);
+                            batchSizes[begin] = end - begin;
+                            for (size_t docId = begin; docId < end; ++docId) {
+                                texts[docId - begin] = docs[docId];
+                            }
+                        },
+                        [&](size_t docId, DocumentTerms& terms) {
+                            ASSERT_EQ(docId, nextDocId++);
+                            ASSERT_EQ(terms.terms.size(), 2u);
+                            EXPECT_EQ(terms.Word(terms.terms[1]), letters(docId));
+                        },
+                        16);
+
+    EXPECT_EQ(nextDocId, docs.size());
+    for (size_t begin = 0; begin < docs.size(); begin += 16) {
+        EXPECT_EQ(batchSizes[begin], min<size_t>(16, docs.size() - begin)) << begin;
+    }
+}
+
+TEST(TestCaseIndexPipeline, TestPipelineRethrowsStageErrors) {
+    IndexPipeline pipeline(2, 2);
+    EXPECT_THROW(pipeline.Run(100,
+                              [](size_t docId) -> string {
+                                  if (docId == 50) {
+                                      throw runtime_error("read failed");
+                                  }
+                                  return "text";
+                              },
+                              [](size_t, DocumentTerms&) {}),
+                 runtime_error);
+    EXPECT_THROW(pipeline.Run(100,
+                              [](size_t) { return string("text"); },
+                              [](size_t docId, DocumentTerms&) {
+                                  if (docId == 10) {
+                                      throw runtime_error("sink failed");
+                                  }
+                              }),
+                 runtime_error);
+    EXPECT_THROW(pipeline.RunSharded(100,
+                                     [](size_t, size_t, vector<string>& texts) { texts[0] = "text"; },
+                                     [](size_t, size_t docId, DocumentTerms&) {
+                                         if (docId == 10) {
+                                             throw runtime_error("shard failed");
+                                         }
+                                     },
+                                     1, 3),
+                 runtime_error);
+}
+
+TEST(TestCaseIndexPipeline, TestSlowDocumentDoesNotGrowReorderBuffer) {
+    // Первый документ читается намного дольше остальных: без окна читатели
+    // успели бы прочитать и токенизировать почти весь корпус
+    IndexPipeline pipeline(2, 4, 4);
+    atomic<size_t> inFlight{0};
+    atomic<size_t> peak{0};
+    size_t indexed = 0;
+
+    pipeline.Run(2000,
+                 [&](size_t docId) -> string {
+                     const size_t current = ++inFlight;
+                     for (size_t seen = peak.load(); current > seen && !peak.compare_exchange_weak(seen, current); ) {
+                     }
+                     if (docId == 0) {
+                         this_thread::sleep_for(chrono::milliseconds(200));
+                     }
+                     return "slow fast document";
+                 },
+                 [&](size_t docId, DocumentTerms&) {
+                     ASSERT_EQ(docId, indexed++);
+                     --inFlight;
+                 });
+
+    EXPECT_EQ(indexed, 2000u);
+    EXPECT_LE(peak.load(), pipeline.WindowSize());
+    EXPECT_EQ(pipeline.WindowSize(), 8u);
+    EXPECT_EQ(pipeline.WindowSize(32), 32u);
+}
@@ -0,0 +1,185 @@
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../SEGW/include/InvertedIndex.h"
+#include "../SEGW/include/SearchServer.h"
+
+using namespace std;
+
+namespace {
+
+const vector<string> kDocs = {
+        "milk milk milk milk water water water",
+        "milk water water",
+        "milk milk milk milk milk water water water water water",
+        "americano cappuccino"
+};
+
+void CheckSegmentRoundTrip(bool compressed) {
+    const string path = compressed ? "test_index_compressed.seg" : "test_index_raw.seg";
+
+    InvertedIndex built;
+    built.SetCompression(compressed);
+    built.UpdateDocumentBase(kDocs, {"one.txt", "two.txt", "three.txt", "four.txt"});
+    built.SaveSegment(path);
+
+    InvertedIndex loaded;
+    loaded.LoadSegment(path, true);
+
+    for (size_t doc_id = 0; doc_id < kDocs.size(); ++doc_id) {
+        const DocumentInfo expected = built.GetDocumentInfo(doc_id);
+        const DocumentInfo actual = loaded.GetDocumentInfo(doc_id);
+        EXPECT_EQ(actual.length, kDocs[doc_id].size());
+        EXPECT_EQ(actual.tokenCount, expected.tokenCount);
+        EXPECT_EQ(actual.source, expected.source);
+    }
+
+    EXPECT_EQ(loaded.IsCompressed(), compressed);
+    EXPECT_EQ(loaded.GetDocumentCount(), kDocs.size());
+    for (const auto& word : {"milk", "water", "americano", "cappuccino", "sugar"}) {
+        EXPECT_EQ(built.GetWordCount(word), loaded.GetWordCount(word)) << word;
+        EXPECT_EQ(built.ContainsWord(word), loaded.ContainsWord(word)) << word;
+    }
+    EXPECT_EQ(built.GetStats().totalWords, loaded.GetStats().totalWords);
+    EXPECT_EQ(built.GetStats().totalEntries, loaded.GetStats().totalEntries);
+
+    const vector<string> queries = {"milk water", "sugar", "cappuccino"};
+    EXPECT_EQ(SearchServer(built).search(queries), SearchServer(loaded).search(queries));
+
+    std::remove(path.c_str());
+}
+
+} // namespace
+
+TEST(TestCaseIndexSegment, TestRawRoundTrip) {
+    CheckSegmentRoundTrip(false);
+}
+
+TEST(TestCaseIndexSegment, TestCompressedRoundTrip) {
+    CheckSegmentRoundTrip(true);
+}
+
+TEST(TestCaseIndexSegment, TestRejectsCorruptedSegment) {
+    const string path = "test_index_corrupted.seg";
+
+    InvertedIndex built;
+    built.UpdateDocumentBase(kDocs);
+    built.SaveSegment(path);
+
+    // Портим один байт в секции списков вхождений
+    {
+        fstream file(path, ios::in | ios::out | ios::binary);
+        file.seekp(sizeof(SegmentHeader));
+        file.put('\x7f');
+    }
+
+    InvertedIndex loaded;
+    EXPECT_THROW(loaded.LoadSegment(path, true), runtime_error);
+
+    {
+        ofstream file(path, ios::binary | ios::trunc);
+        file << "not a segment, just some text padded to header size............................................................................";
+    }
+    EXPECT_THROW(loaded.LoadSegment(path), runtime_error);
+
+    std::remove(path.c_str());
+}
+
+TEST(TestCaseIndexSegment, TestRejectsInconsistentLayout) {
+    const string path = "test_index_layout.seg";
+
+    InvertedIndex built;
+    built.UpdateDocumentBase(kDocs);
+    built.SaveSegment(path);
+
+    SegmentHeader header;
+    {
+        ifstream file(path, ios::binary);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    }
+
+    // Смещение слова за пределами секции termBytes: структура проверяется и без verify
+    {
+        fstream file(path, ios::in | ios::out | ios::binary);
+        const uint64_t offset = header.termBytesSize + 100;
+        file.seekp(header.termOffsetsOffset + sizeof(uint64_t));
+        file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    }
+    EXPECT_THROW(IndexSegment::Open(path, false), runtime_error);
+
+    // Слот, ссылающийся на несуществующее слово
+    built.SaveSegment(path);
+    {
+        fstream file(path, ios::in | ios::out | ios::binary);
+        const SegmentSlot slot{0, static_cast<uint32_t>(header.termCount)};
+        file.seekp(header.slotsOffset);
+        file.write(reinterpret_cast<const char*>(&slot), sizeof(slot));
+    }
+    EXPECT_THROW(IndexSegment::Open(path, false), runtime_error);
+
+    std::remove(path.c_str());
+}
+
+TEST(TestCaseIndexSegment, TestRejectsOutOfRangeDocuments) {
+    const string path = "test_index_doc_range.seg";
+
+    // Контрольная сумма верна, но doc_id списка больше числа документов
+    {
+        SegmentWriter writer(path, false);
+        writer.AddTerm("milk", {{0, 1}, {7, 2}});
+        writer.AddDocument(4);
+        writer.AddDocument(4);
+        writer.Finish();
+    }
+    EXPECT_NO_THROW(IndexSegment::Open(path, false));
+    EXPECT_THROW(IndexSegment::Open(path), runtime_error);
+    // Загрузка по умолчанию не пропускает такой сегмент к поиску
+    InvertedIndex loaded;
+    EXPECT_THROW(loaded.LoadSegment(path), runtime_error);
+
+    // Обрыв сжатого списка внутри секции
+    {
+        SegmentWriter writer(path, true);
+        const uint8_t truncated[] = {3, 0};
+        writer.AddEncodedTerm("milk", truncated, sizeof(truncated));
+        writer.AddDocument(4);
+        writer.Finish();
+    }
+    EXPECT_THROW(IndexSegment::Open(path, true), runtime_error);
+
+    std::remove(path.c_str());
+}
+
+TEST(TestCaseIndexSegment, TestRemovedDocumentsSurviveReload) {
+    const string path = "test_index_removed.seg";
+
+    InvertedIndex built;
+    built.UpdateDocumentBase({"milk water", "sugar milk", "water tea"}, {"a.txt", "b.txt", "c.txt"});
+    built.RemoveDocument(1);
+    built.SaveSegment(path);
+
+    InvertedIndex loaded;
+    loaded.LoadSegment(path, true);
+
+    EXPECT_EQ(loaded.GetStats().totalDocuments, built.GetStats().totalDocuments);
+    EXPECT_EQ(loaded.GetStats().totalWords, built.GetStats().totalWords);
+    EXPECT_EQ(loaded.GetStats().totalEntries, built.GetStats().totalEntries);
+    EXPECT_EQ(loaded.GetDocumentCount(), built.GetDocumentCount());
+    EXPECT_TRUE(loaded.IsRemoved(1));
+    EXPECT_FALSE(loaded.IsRemoved(0));
+    EXPECT_EQ(loaded.GetDocumentInfo(1).source, "b.txt");
+
+    for (const auto& word : {"milk", "water", "tea", "sugar"}) {
+        EXPECT_EQ(built.GetWordCount(word), loaded.GetWordCount(word)) << word;
+        EXPECT_EQ(built.ContainsWord(word), loaded.ContainsWord(word)) << word;
+    }
+    EXPECT_FALSE(loaded.ContainsWord("sugar"));
+
+    const vector<string> queries = {"milk", "sugar", "water tea"};
+    EXPECT_EQ(SearchServer(built).search(queries), SearchServer(loaded).search(queries));
+
+    std::remove(path.c_str());
+}
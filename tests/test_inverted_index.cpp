@@ -76,3 +76,101 @@ TEST(TestCaseInvertedIndex, TestInvertedIndexMissingWord) {
 }
 
 
+
+TEST(TestCaseInvertedIndex, TestParallelBuildMatchesSerial) {
+    const vector<string> vocabulary = {
+            "milk", "water", "london", "capital", "tea", "Soda", "bell", "clock"
+    };
+    vector<string> docs;
+    for (size_t i = 0; i < 257; ++i) {
+        string doc;
+        for (size_t j = 0; j <= i % 11; ++j) {
+            doc += vocabulary[(i * 7 + j * 3) % vocabulary.size()] + " ";
+        }
+        docs.push_back(doc);
+    }
+
+    InvertedIndex serial(1);
+    serial.UpdateDocumentBase(docs);
+    InvertedIndex parallel(8);
+    parallel.UpdateDocumentBase(docs);
+
+    for (const auto& word : {"milk", "water", "london", "capital", "tea", "soda", "bell", "clock"}) {
+        ASSERT_EQ(serial.GetWordCount(word), parallel.GetWordCount(word)) << word;
+    }
+    ASSERT_EQ(serial.GetStats().totalWords, parallel.GetStats().totalWords);
+    ASSERT_EQ(serial.GetStats().totalEntries, parallel.GetStats().totalEntries);
+}
+
+TEST(TestCaseInvertedIndex, TestPostingsViewMatchesWordCount) {
+    const vector<string> docs = {
+            "milk milk milk milk water water water",
+            "milk water water",
+            "americano cappuccino"
+    };
+    InvertedIndex idx;
+    idx.UpdateDocumentBase(docs);
+
+    PostingsView milk = idx.GetPostings("milk");
+    ASSERT_EQ(milk.size(), 2u);
+    EXPECT_EQ(vector<Entry>(milk.begin(), milk.end()), idx.GetWordCount("milk"));
+    EXPECT_EQ(milk[1].doc_id, 1u);
+
+    EXPECT_TRUE(idx.GetPostings("sugar").empty());
+}
+
+TEST(TestCaseInvertedIndex, TestIncrementalUpdates) {
+    InvertedIndex idx;
+    idx.UpdateDocumentBase({
+            "milk milk water",
+            "water tea"
+    });
+
+    EXPECT_EQ(idx.AddDocument("milk sugar"), 2u);
+    EXPECT_EQ(idx.GetWordCount("milk"), (vector<Entry>{{0, 2}, {2, 1}}));
+
+    idx.UpdateDocument(0, "tea tea tea");
+    EXPECT_EQ(idx.GetWordCount("milk"), (vector<Entry>{{2, 1}}));
+    EXPECT_EQ(idx.GetWordCount("tea"), (vector<Entry>{{0, 3}, {1, 1}}));
+    EXPECT_EQ(idx.GetWordCount("water"), (vector<Entry>{{1, 1}}));
+
+    idx.RemoveDocument(1);
+    EXPECT_TRUE(idx.IsRemoved(1));
+    EXPECT_EQ(idx.GetWordCount("tea"), (vector<Entry>{{0, 3}}));
+    EXPECT_FALSE(idx.ContainsWord("water"));
+
+    IndexStats stats = idx.GetStats();
+    EXPECT_EQ(stats.totalDocuments, 2u);
+    EXPECT_EQ(stats.totalWords, 3u);   // tea, milk, sugar
+    EXPECT_EQ(stats.totalEntries, 3u);
+
+    idx.Compact();
+    EXPECT_EQ(idx.GetStats().totalEntries, 3u);
+    EXPECT_EQ(idx.GetDocumentCount(), 3u);
+    EXPECT_EQ(idx.AddDocument("water"), 3u);
+    EXPECT_EQ(idx.GetWordCount("water"), (vector<Entry>{{3, 1}}));
+}
+
+TEST(TestCaseInvertedIndex, TestDocumentMetadata) {
+    vector<string> docs = {
+            "Milk, milk and water!",
+            "sugar"
+    };
+    InvertedIndex idx;
+    idx.UpdateDocumentBase(std::move(docs), {"a.txt", "b.txt"});
+
+    const DocumentInfo first = idx.GetDocumentInfo(0);
+    EXPECT_EQ(first.length, 21u);
+    EXPECT_EQ(first.tokenCount, 4u);
+    EXPECT_EQ(first.source, "a.txt");
+    EXPECT_EQ(idx.GetWordCount("milk"), (vector<Entry>{{0, 2}}));
+
+    idx.UpdateDocument(0, "tea");
+    EXPECT_EQ(idx.GetDocumentInfo(0).tokenCount, 1u);
+    EXPECT_EQ(idx.GetDocumentInfo(0).source, "a.txt");
+    EXPECT_TRUE(idx.GetWordCount("milk").empty());
+
+    EXPECT_EQ(idx.AddDocument("green tea", "c.txt"), 2u);
+    EXPECT_EQ(idx.GetDocumentInfo(2).source, "c.txt");
+    EXPECT_THROW(idx.GetDocumentInfo(3), out_of_range);
+}
@@ -0,0 +1,98 @@
+#include <sstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include "../SEGW/include/JsonSaxReader.h"
+
+using namespace std;
+
+namespace {
+
+struct Parsed {
+    vector<string> files;
+    nlohmann::json config;
+    bool hasConfig = false;
+    bool filesArray = false;
+};
+
+Parsed ParseText(const string& text) {
+    Parsed parsed;
+    JsonSaxReader reader;
+    reader.Keep("config");
+    reader.StreamStrings("files", [&parsed](string& file) { parsed.files.push_back(move(file)); });
+    istringstream input(text);
+    reader.Parse(input);
+    parsed.config = reader.Kept("config");
+    parsed.hasConfig = reader.Contains("config");
+    parsed.filesArray = reader.WasArray("files");
+    return parsed;
+}
+
+} // namespace
+
+TEST(TestCaseJsonSaxReader, TestKeptSectionMatchesDom) {
+    const nlohmann::json document = {
+        {"big", {{"nested", {1, 2, {{"deep", "x"}}}}, {"skip", nullptr}}},
+        {"config", {
+            {"name", "Engine"},
+            {"max_responses", 5},
+            {"ratio", -1.5},
+            {"flag", true},
+            {"negative", -7},
+            {"extensions", {".txt", ".md"}},
+            {"nested", {{"a", {{"b", {1, {2, 3}}}}}}},
+            {"empty", nlohmann::json::object()}
+        }},
+        {"files", {"a.txt", 5, {"inner.txt"}, {{"k", "v"}}, "b.txt"}},
+        {"tail", "value"}
+    };
+    const Parsed parsed = ParseText(document.dump(2));
+    EXPECT_TRUE(parsed.hasConfig);
+    EXPECT_EQ(parsed.config, document["config"]);
+    // В массив попадают только строки верхнего уровня массива
+    EXPECT_TRUE(parsed.filesArray);
+    EXPECT_EQ(parsed.files, (vector<string>{"a.txt", "b.txt"}));
+}
+
+TEST(TestCaseJsonSaxReader, TestMissingAndMistypedKeys) {
+    Parsed parsed = ParseText(R"({"files": "not an array", "other": {"config": {"name": "x"}}})");
+    EXPECT_FALSE(parsed.hasConfig);
+    EXPECT_TRUE(parsed.config.is_null());
+    EXPECT_FALSE(parsed.filesArray);
+    EXPECT_TRUE(parsed.files.empty());
+
+    parsed = ParseText(R"([{"config": {"name": "x"}, "files": ["a"]}])");
+    EXPECT_FALSE(parsed.hasConfig);
+    EXPECT_TRUE(parsed.files.empty());
+
+    // Повторный ключ внутри собираемого раздела перезаписывает значение, как в DOM
+    parsed = ParseText(R"({"config": {"name": "a", "name": "b"}, "config2": 1})");
+    EXPECT_EQ(parsed.config, nlohmann::json::parse(R"({"name": "a", "name": "b"})"));
+    parsed = ParseText(R"({"config": 42})");
+    EXPECT_TRUE(parsed.hasConfig);
+    EXPECT_EQ(parsed.config, 42);
+}
+
+TEST(TestCaseJsonSaxReader, TestSyntaxErrorsMatchOperator) {
+    for (const string text : {R"({"config": {"name": "x",}})", R"({"files": ["a" "b"]})", "", "{"}) {
+        string domError;
+        try {
+            istringstream input(text);
+            nlohmann::json dom;
+            input >> dom;
+        } catch (const nlohmann::json::parse_error& e) {
+            domError = e.what();
+        }
+        string saxError;
+        try {
+            ParseText(text);
+        } catch (const nlohmann::json::parse_error& e) {
+            saxError = e.what();
+        }
+        EXPECT_FALSE(domError.empty()) << text;
+        EXPECT_EQ(saxError, domError) << text;
+    }
+    // Данные после документа, как и у operator>>, не проверяются
+    EXPECT_EQ(ParseText(R"({"files": ["a"]} trailing)").files, vector<string>{"a"});
+}
@@ -0,0 +1,51 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../SEGW/include/RequestSource.h"
+
+using namespace std;
+
+namespace {
+
+vector<string> ReadAll(RequestSource& source) {
+    vector<string> requests;
+    string request;
+    while (source.Next(request)) {
+        requests.push_back(request);
+    }
+    return requests;
+}
+
+} // namespace
+
+TEST(TestCaseRequestSource, TestJsonLinesAreStreamed) {
+    const string path = "test_requests.jsonl";
+    ofstream(path, ios::binary) << "\"milk water\"\n"
+                                << "\n"
+                                << "{\"request\": \"sugar\", \"id\": 7}\r\n"
+                                << "not json\n"
+                                << "\"\"\n"
+                                << "\"\\u043c\\u043e\\u043b\\u043e\\u043a\\u043e\"\n"
+                                << "42\n"
+                                << "\"last without newline\"";
+
+    RequestSource source(path);
+    EXPECT_TRUE(source.IsStreaming());
+    EXPECT_EQ(ReadAll(source), (vector<string>{"milk water", "sugar", "молоко", "last without newline"}));
+    EXPECT_EQ(source.SkippedLines(), 2u);
+    remove(path.c_str());
+}
+
+TEST(TestCaseRequestSource, TestLegacyJsonFormat) {
+    const string path = "test_requests_legacy.json";
+    ofstream(path) << R"({"requests": ["milk", "", "water", 5]})";
+
+    RequestSource source(path);
+    EXPECT_FALSE(source.IsStreaming());
+    EXPECT_EQ(ReadAll(source), (vector<string>{"milk", "water"}));
+    remove(path.c_str());
+
+    EXPECT_THROW(RequestSource("missing_requests.jsonl"), runtime_error);
+}
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 #include <string>
 #include <gtest/gtest.h>
@@ -80,4 +83,163 @@ TEST(TestCaseSearchServer, TestTop5) {
     std::vector<vector<RelativeIndex>> result = srv.search(request);
 
     ASSERT_EQ(result, expected);
-}
\ No newline at end of file
+}
+
+TEST(TestCaseSearchServer, TestTopKKeepsLowestIdsOnTies) {
+    vector<string> docs;
+    for (size_t i = 0; i < 300; ++i) {
+        docs.push_back(i % 50 == 7 ? "tea tea" : "tea water");
+    }
+
+    InvertedIndex idx;
+    idx.UpdateDocumentBase(docs);
+    SearchServer srv(idx);
+
+    const std::vector<vector<RelativeIndex>> expected = {
+            {
+                    {7, 1},
+                    {57, 1},
+                    {107, 1},
+                    {157, 1},
+                    {207, 1},
+                    {257, 1},
+                    {0, 0.5},
+                    {1, 0.5}
+            }
+    };
+
+    ASSERT_EQ(srv.search({"tea"}, 8), expected);
+}
+
+TEST(TestCaseSearchServer, TestPooledBatchMatchesSerial) {
+    const vector<string> docs = {
+            "milk milk milk milk water water water",
+            "milk water water",
+            "milk milk milk milk milk water water water water water",
+            "americano cappuccino"
+    };
+    const vector<string> queries = {"milk water", "sugar", "cappuccino", "water", "milk"};
+    vector<string> batch;
+    for (size_t i = 0; i < 500; ++i) {
+        batch.push_back(queries[i % queries.size()]);
+    }
+
+    InvertedIndex idx;
+    idx.UpdateDocumentBase(docs);
+    SearchServer serial(idx, 1);
+    SearchServer pooled(idx, 4);
+
+    ASSERT_EQ(serial.search(batch), pooled.search(batch));
+}
+
+TEST(TestCaseSearchServer, TestConcurrentCallsShareServer) {
+    const vector<string> docs = {
+            "milk milk milk milk water water water",
+            "milk water water",
+            "milk milk milk milk milk water water water water water",
+            "americano cappuccino"
+    };
+    const vector<string> first = {"milk water", "sugar", "cappuccino"};
+    const vector<string> second = {"water", "milk", "americano water"};
+    vector<string> firstBatch, secondBatch;
+    for (size_t i = 0; i < 2000; ++i) {
+        firstBatch.push_back(first[i % first.size()]);
+        secondBatch.push_back(second[i % second.size()]);
+    }
+
+    InvertedIndex idx;
+    idx.UpdateDocumentBase(docs);
+    SearchServer serial(idx, 1);
+    const auto firstExpected = serial.search(firstBatch);
+    const auto secondExpected = serial.search(secondBatch);
+
+    // Два потока одновременно вызывают search у одного сервера
+    SearchServer shared(idx, 4);
+    vector<vector<RelativeIndex>> firstResult, secondResult;
+    for (int round = 0; round < 5; ++round) {
+        thread other([&]() { secondResult = shared.search(secondBatch); });
+        firstResult = shared.search(firstBatch);
+        other.join();
+
+        ASSERT_EQ(firstResult, firstExpected);
+        ASSERT_EQ(secondResult, secondExpected);
+    }
+}
+
+TEST(TestCaseSearchServer, TestStreamMatchesBatch) {
+    const vector<string> docs = {
+            "milk milk milk milk water water water",
+            "milk water water",
+            "americano cappuccino"
+    };
+    const vector<string> queries = {"milk water", "sugar", "cappuccino", "water", "milk"};
+    vector<string> batch;
+    for (size_t i = 0; i < 1003; ++i) {
+        batch.push_back(queries[i % queries.size()]);
+    }
+
+    InvertedIndex idx;
+    idx.UpdateDocumentBase(docs);
+    SearchServer server(idx, 4);
+    const vector<vector<RelativeIndex>> expected = server.search(batch, 2);
+
+    // Пакеты по 64 запроса: последний неполный, порядок выдачи сохраняется
+    size_t nextRequest = 0;
+    vector<vector<RelativeIndex>> streamed;
+    const SearchServer::SearchStats stats = server.searchStream(
+        [&](string& request) {
+            if (nextRequest == batch.size()) {
+                return false;
+            }
+            request = batch[nextRequest++];
+            return true;
+        },
+        [&](size_t requestIndex, vector<RelativeIndex>& results) {
+            ASSERT_EQ(requestIndex, streamed.size());
+            streamed.push_back(move(results));
+        },
+        2, 64);
+
+    EXPECT_EQ(streamed, expected);
+    EXPECT_EQ(stats.totalQueries, batch.size());
+    EXPECT_EQ(stats.queriesWithResults, static_cast<size_t>(count_if(
+        expected.begin(), expected.end(), [](const vector<RelativeIndex>& r) { return !r.empty(); })));
+    EXPECT_FLOAT_EQ(stats.averageWordsPerQuery, server.getSearchStats(batch).averageWordsPerQuery);
+}
+
+TEST(TestCaseSearchServer, TestStreamRethrowsReaderErrors) {
+    InvertedIndex idx;
+    idx.UpdateDocumentBase({"milk water"});
+    SearchServer server(idx, 2);
+    size_t calls = 0;
+    EXPECT_THROW(server.searchStream(
+                     [&](string& request) {
+                         if (++calls > 100) {
+                             throw runtime_error("broken source");
+                         }
+                         request = "milk";
+                         return true;
+                     },
+                     [](size_t, vector<RelativeIndex>&) {}, 5, 8),
+                 runtime_error);
+}
+
+TEST(TestCaseSearchServer, TestRemovedDocumentsAreSkipped) {
+    InvertedIndex idx;
+    idx.UpdateDocumentBase({
+            "milk milk milk",
+            "milk water",
+            "milk"
+    });
+    idx.RemoveDocument(0);
+
+    SearchServer srv(idx);
+    const std::vector<vector<RelativeIndex>> expected = {
+            {
+                    {1, 1},
+                    {2, 1}
+            }
+    };
+
+    ASSERT_EQ(srv.search({"milk"}), expected);
+}
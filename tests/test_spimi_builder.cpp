@@ -0,0 +1,180 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <gtest/gtest.h>
+#include "../SEGW/include/InvertedIndex.h"
+#include "../SEGW/include/SpimiBuilder.h"
+
+using namespace std;
+
+namespace {
+
+vector<string> MakeCorpus(size_t doc_count) {
+    mt19937 rng(5);
+    uniform_int_distribution<size_t> word(0, 400);
+    uniform_int_distribution<size_t> length(1, 40);
+    vector<string> docs;
+    for (size_t i = 0; i < doc_count; ++i) {
+        string text;
+        for (size_t j = length(rng); j > 0; --j) {
+            text += "w" + string(1, static_cast<char>('a' + word(rng) % 26)) + to_string(word(rng)) + " ";
+        }
+        docs.push_back(text);
+    }
+    return docs;
+}
+
+// Ни одного файла построения не осталось: ни run-файлов, ни сегмента, ни временных
+void ExpectNoBuildFiles(const string& path, size_t maxRun) {
+    for (size_t run = 0; run <= maxRun; ++run) {
+        EXPECT_FALSE(ifstream(path + ".run" + to_string(run)).is_open()) << run;
+    }
+    EXPECT_FALSE(ifstream(path).is_open());
+    EXPECT_FALSE(ifstream(path + ".docs").is_open());
+    EXPECT_FALSE(ifstream(path + ".sources").is_open());
+}
+
+} // namespace
+
+TEST(TestCaseSpimiBuilder, TestFailedFlushRemovesRuns) {
+    const string path = "test_spimi_failed_flush.seg";
+    const vector<string> docs = MakeCorpus(20);
+
+    // Каталог на месте четвертого run-файла: его создание завершится ошибкой
+    filesystem::create_directory(path + ".run3");
+    {
+        SpimiBuilder builder(path, 1, false);
+        EXPECT_THROW({
+            for (const string& doc : docs) {
+                builder.AddDocument(doc, "doc.txt");
+            }
+        }, runtime_error);
+        EXPECT_EQ(builder.RunCount(), 4u);
+    }
+    filesystem::remove(path + ".run3");
+
+    ExpectNoBuildFiles(path, docs.size());
+}
+
+TEST(TestCaseSpimiBuilder, TestFailedMergeRemovesRuns) {
+    const string path = "test_spimi_failed_merge.seg";
+    const vector<string> docs = MakeCorpus(SpimiBuilder::kMaxMergeFanIn + 10);
+
+    // Каталог на месте первого промежуточного run-файла: слияние завершится ошибкой
+    filesystem::create_directory(path + ".run" + to_string(docs.size()));
+    {
+        SpimiBuilder builder(path, 1, true);
+        for (const string& doc : docs) {
+            builder.AddDocument(doc, "doc.txt");
+        }
+        ASSERT_EQ(builder.RunCount(), docs.size());
+        EXPECT_THROW(builder.Finish(), runtime_error);
+    }
+    filesystem::remove(path + ".run" + to_string(docs.size()));
+
+    ExpectNoBuildFiles(path, docs.size() - 1);
+}
+
+TEST(TestCaseSpimiBuilder, TestMergeFanInIsBounded) {
+    const string path = "test_spimi_fan_in.seg";
+    const vector<string> docs = MakeCorpus(300);
+
+    InvertedIndex expected;
+    expected.UpdateDocumentBase(docs);
+
+    // Бюджет в 1 байт: каждый документ сбрасывается в свой run-файл
+    SpimiBuilder builder(path, 1, false);
+    for (const string& doc : docs) {
+        builder.AddDocument(doc);
+    }
+    ASSERT_GT(builder.RunCount(), 2 * SpimiBuilder::kMaxMergeFanIn);
+
+    // Лимит открытых файлов меньше числа run-файлов: слияние идет в несколько проходов
+    rlimit saved;
+    ASSERT_EQ(getrlimit(RLIMIT_NOFILE, &saved), 0);
+    rlimit limited = saved;
+    limited.rlim_cur = SpimiBuilder::kMaxMergeFanIn + 32;
+    ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &limited), 0);
+    EXPECT_NO_THROW(builder.Finish());
+    setrlimit(RLIMIT_NOFILE, &saved);
+
+    for (size_t run = 0; run < builder.RunCount() + 4; ++run) {
+        EXPECT_FALSE(ifstream(path + ".run" + to_string(run)).is_open()) << run;
+    }
+
+    InvertedIndex loaded;
+    loaded.LoadSegment(path, true);
+    EXPECT_EQ(loaded.GetDocumentCount(), docs.size());
+    EXPECT_EQ(loaded.GetStats().totalWords, expected.GetStats().totalWords);
+    EXPECT_EQ(loaded.GetStats().totalEntries, expected.GetStats().totalEntries);
+    for (size_t i = 0; i < 400; ++i) {
+        const string word = "w" + string(1, static_cast<char>('a' + i % 26)) + to_string(i);
+        ASSERT_EQ(loaded.GetWordCount(word), expected.GetWordCount(word)) << word;
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST(TestCaseSpimiBuilder, TestDocumentMetadataStaysOutOfMemory) {
+    const string path = "test_spimi_metadata.seg";
+    const vector<string> docs = MakeCorpus(2000);
+    const size_t budget = 64 * 1024;
+
+    // Пути документов вместе занимают больше всего бюджета
+    auto sourceOf = [](size_t docId) {
+        return "resources/" + string(200, 'p') + "/" + to_string(docId) + ".txt";
+    };
+
+    SpimiBuilder builder(path, budget, true);
+    for (size_t docId = 0; docId < docs.size(); ++docId) {
+        builder.AddDocument(docs[docId], sourceOf(docId));
+        ASSERT_LE(builder.MemoryUsage(), budget) << docId;
+    }
+    builder.Finish();
+    EXPECT_FALSE(ifstream(path + ".docs").is_open());
+    EXPECT_FALSE(ifstream(path + ".sources").is_open());
+
+    InvertedIndex loaded;
+    loaded.LoadSegment(path, true);
+    ASSERT_EQ(loaded.GetDocumentCount(), docs.size());
+    for (size_t docId = 0; docId < docs.size(); docId += 97) {
+        EXPECT_EQ(loaded.GetDocumentInfo(docId).source, sourceOf(docId));
+        EXPECT_EQ(loaded.GetDocumentInfo(docId).length, docs[docId].size());
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST(TestCaseSpimiBuilder, TestFrequentTermStreamsAcrossRuns) {
+    // Одно слово во всех документах: его список собирается из сотен run-файлов,
+    // чьи последние блоки неполные, и проходит через промежуточное слияние
+    const size_t docCount = 3 * SpimiBuilder::kMaxMergeFanIn + 7;
+    for (bool compressed : {false, true}) {
+        const string path = "test_spimi_frequent.seg";
+        {
+            SpimiBuilder builder(path, 1, compressed);
+            for (size_t docId = 0; docId < docCount; ++docId) {
+                builder.AddDocument(docId % 3 == 1 ? "common common" : "common");
+            }
+            builder.Finish();
+        }
+
+        InvertedIndex loaded;
+        loaded.LoadSegment(path, true);
+        vector<Entry> entries;
+        for (PostingCursor cursor = loaded.GetCursor("common"); cursor.Next(); ) {
+            entries.insert(entries.end(), cursor.Block().begin(), cursor.Block().end());
+        }
+        ASSERT_EQ(entries.size(), docCount) << compressed;
+        for (size_t docId = 0; docId < docCount; ++docId) {
+            EXPECT_EQ(entries[docId], (Entry{docId, docId % 3 == 1 ? 2u : 1u})) << docId;
+        }
+
+        std::remove(path.c_str());
+    }
+}
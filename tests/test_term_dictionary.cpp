@@ -0,0 +1,62 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../SEGW/include/StringArena.h"
+#include "../SEGW/include/TermDictionary.h"
+
+using namespace std;
+
+TEST(TestCaseTermDictionary, TestDenseIds) {
+    TermDictionary dictionary;
+
+    EXPECT_EQ(dictionary.Find("milk"), TermDictionary::kNoTerm);
+    EXPECT_EQ(dictionary.Intern("milk"), 0u);
+    EXPECT_EQ(dictionary.Intern("water"), 1u);
+    EXPECT_EQ(dictionary.Intern("milk"), 0u);
+
+    EXPECT_EQ(dictionary.Size(), 2u);
+    EXPECT_EQ(dictionary.Find("water"), 1u);
+    EXPECT_EQ(dictionary.Term(0), "milk");
+}
+
+TEST(TestCaseTermDictionary, TestGrowKeepsIds) {
+    TermDictionary dictionary;
+    vector<string> words;
+    for (size_t i = 0; i < 10000; ++i) {
+        words.push_back("term" + to_string(i));
+        ASSERT_EQ(dictionary.Intern(words.back()), i);
+    }
+
+    for (size_t i = 0; i < words.size(); ++i) {
+        ASSERT_EQ(dictionary.Find(words[i]), i);
+        ASSERT_EQ(dictionary.Term(static_cast<uint32_t>(i)), words[i]);
+    }
+    EXPECT_EQ(dictionary.Find("term10000"), TermDictionary::kNoTerm);
+}
+
+TEST(TestCaseTermDictionary, TestArenaKeepsViewsStable) {
+    StringArena arena;
+    vector<string_view> views;
+    vector<string> expected;
+    for (size_t i = 0; i < 20000; ++i) {
+        expected.push_back("word" + to_string(i));
+        views.push_back(arena.Store(expected.back()));
+    }
+    const string large(StringArena::kBlockSize, 'x');
+    views.push_back(arena.Store(large));
+    expected.push_back(large);
+
+    // Перемещение арены не перемещает байты
+    StringArena moved = std::move(arena);
+    for (size_t i = 0; i < views.size(); ++i) {
+        ASSERT_EQ(views[i], expected[i]);
+    }
+    EXPECT_GE(moved.AllocatedBytes(), moved.UsedBytes());
+
+    TermDictionary dictionary;
+    dictionary.Intern("milk");
+    TermDictionary other = std::move(dictionary);
+    EXPECT_EQ(other.Term(0), "milk");
+    EXPECT_EQ(other.Find("milk"), 0u);
+}
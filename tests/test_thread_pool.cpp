@@ -0,0 +1,35 @@
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../SEGW/include/ThreadPool.h"
+
+TEST(TestCaseThreadPool, TestParallelForVisitsEveryIndexOnce) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> visits(1000);
+
+    for (int round = 0; round < 3; ++round) {
+        pool.ParallelFor(visits.size(), 7, [&visits, &pool](size_t begin, size_t end, size_t worker) {
+            ASSERT_LT(worker, pool.Size());
+            for (size_t i = begin; i < end; ++i) {
+                visits[i].fetch_add(1);
+            }
+        });
+    }
+
+    for (const auto& count : visits) {
+        ASSERT_EQ(count.load(), 3);
+    }
+}
+
+TEST(TestCaseThreadPool, TestParallelForRethrows) {
+    ThreadPool pool(2);
+
+    EXPECT_THROW(
+        pool.ParallelFor(10, 1, [](size_t begin, size_t, size_t) {
+            if (begin == 5) {
+                throw std::runtime_error("task failed");
+            }
+        }),
+        std::runtime_error);
+}
@@ -0,0 +1,188 @@
+#include <cctype>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "../SEGW/include/DocumentTerms.h"
+#include "../SEGW/include/Tokenizer.h"
+#include "../SEGW/include/Utf8.h"
+
+using namespace std;
+
+namespace {
+
+// Прежняя нормализация через istringstream и isalpha/tolower;
+// на тексте без корректных последовательностей UTF-8 совпадает с текущей
+vector<string> LegacyTokenize(const string& text) {
+    vector<string> words;
+    istringstream stream(text);
+    string word;
+    while (stream >> word) {
+        string normalized;
+        for (char c : word) {
+            if (isalpha(static_cast<unsigned char>(c))) {
+                normalized += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+            }
+        }
+        if (!normalized.empty()) {
+            words.push_back(normalized);
+        }
+    }
+    return words;
+}
+
+vector<string> ToStrings(const vector<string_view>& tokens) {
+    return vector<string>(tokens.begin(), tokens.end());
+}
+
+} // namespace
+
+TEST(TestCaseTokenizer, TestNormalization) {
+    Tokenizer tokenizer;
+    const vector<string> expected = {"london", "is", "dont", "bigben"};
+
+    EXPECT_EQ(ToStrings(tokenizer.Tokenize("  London\tis 42 Don't\n\nBig-Ben! ")), expected);
+    EXPECT_TRUE(tokenizer.Tokenize(" 123 ... ").empty());
+    EXPECT_TRUE(tokenizer.Tokenize("").empty());
+}
+
+TEST(TestCaseTokenizer, TestMatchesLegacyNormalization) {
+    const string alphabet = "abcXYZ019 \t\n\r\v\f.,'-_!\x80\xc0\xff";
+    mt19937 rng(42);
+    uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    Tokenizer tokenizer;
+
+    for (size_t round = 0; round < 200; ++round) {
+        string text;
+        for (size_t i = 0; i < round * 3; ++i) {
+            text += alphabet[pick(rng)];
+        }
+        ASSERT_EQ(ToStrings(tokenizer.Tokenize(text)), LegacyTokenize(text)) << text;
+    }
+}
+
+TEST(TestCaseTokenizer, TestVectorKernelsMatchScalar) {
+    const string alphabet = "abcdefgXYZ019 \t\n\r\v\f.,'-_!@[`{\x80\xc0\xff";
+    mt19937 rng(7);
+    uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    uniform_int_distribution<size_t> runLength(1, 150);
+    Tokenizer scalar(Tokenizer::Kernel::Scalar);
+    ASSERT_EQ(scalar.ActiveKernel(), Tokenizer::Kernel::Scalar);
+
+    for (Tokenizer::Kernel kernel : {Tokenizer::Kernel::Sse2, Tokenizer::Kernel::Avx2}) {
+        if (!Tokenizer::IsSupported(kernel)) {
+            continue;
+        }
+        Tokenizer vectorized(kernel);
+        ASSERT_EQ(vectorized.ActiveKernel(), kernel);
+
+        // Все 256 значений байта, длинные слова через границы блоков и хвосты любой длины
+        string allBytes;
+        for (int c = 0; c < 256; ++c) {
+            allBytes += static_cast<char>(c);
+        }
+        ASSERT_EQ(ToStrings(vectorized.Tokenize(allBytes)), ToStrings(scalar.Tokenize(allBytes)));
+
+        for (size_t round = 0; round < 300; ++round) {
+            string text;
+            while (text.size() < round * 2) {
+                const char c = alphabet[pick(rng)];
+                text.append(round % 3 == 0 ? runLength(rng) : 1, c);
+            }
+            ASSERT_EQ(ToStrings(vectorized.Tokenize(text)), ToStrings(scalar.Tokenize(text))) << text;
+            ASSERT_EQ(ToStrings(vectorized.Tokenize(text)), LegacyTokenize(text)) << text;
+        }
+    }
+}
+
+TEST(TestCaseTokenizer, TestCyrillicAndLatin1) {
+    Tokenizer tokenizer;
+    const vector<string> expected = {
+        "москва", "столица", "ёлка", "straße", "café", "über", "ґанок", "ӏ"
+    };
+
+    EXPECT_EQ(ToStrings(tokenizer.Tokenize(
+                  "МОСКВА — столица! Ёлка STRAẞE? Straße CAFÉ, Über «Ґанок» Ӏ")),
+              (vector<string>{"москва", "столица", "ёлка", "strae", "straße", "café",
+                              "über", "ґанок", "ӏ"}));
+    EXPECT_EQ(ToStrings(tokenizer.Tokenize(
+                  "москва столица ЁЛКА straße café über Ґанок ӏ")), expected);
+
+    // Некорректные и избыточные последовательности отбрасываются, знаки и × ÷ — тоже
+    EXPECT_EQ(ToStrings(tokenizer.Tokenize("при\xd0вет \xc0\xaf\xed\xa0\x80x 2×2 №5")),
+              (vector<string>{"привет", "x"}));
+}
+
+TEST(TestCaseTokenizer, TestUtf8AcrossBlockBoundaries) {
+    const vector<string> pieces = {
+        "a", "Z", " ", "\n", "-", "Ж", "ж", "Ё", "É", "ß", "×", "€", "😀", "\xd0", "\x80"
+    };
+    mt19937 rng(11);
+    uniform_int_distribution<size_t> pick(0, pieces.size() - 1);
+    Tokenizer scalar(Tokenizer::Kernel::Scalar);
+
+    for (size_t round = 0; round < 300; ++round) {
+        string text;
+        while (text.size() < round * 2) {
+            text += pieces[pick(rng)];
+        }
+
+        // Эталон: посимвольный разбор без разбиения на блоки
+        vector<string> expected;
+        string word;
+        const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+        for (size_t pos = 0; pos < text.size();) {
+            char32_t codePoint = 0;
+            size_t length = Utf8::Decode(data + pos, text.size() - pos, codePoint);
+            if (length == 0) {
+                length = 1;
+            } else if (length == 1 && isspace(codePoint)) {
+                if (!word.empty()) {
+                    expected.push_back(word);
+                    word.clear();
+                }
+            } else if (const char32_t folded = Utf8::FoldLetter(codePoint)) {
+                if (folded < 0x80) {
+                    word += static_cast<char>(folded);
+                } else {
+                    word += static_cast<char>(0xC0 | (folded >> 6));
+                    word += static_cast<char>(0x80 | (folded & 0x3F));
+                }
+            }
+            pos += length;
+        }
+        if (!word.empty()) {
+            expected.push_back(word);
+        }
+
+        ASSERT_EQ(ToStrings(scalar.Tokenize(text)), expected) << text;
+        for (Tokenizer::Kernel kernel : {Tokenizer::Kernel::Sse2, Tokenizer::Kernel::Avx2}) {
+            if (Tokenizer::IsSupported(kernel)) {
+                Tokenizer vectorized(kernel);
+                ASSERT_EQ(ToStrings(vectorized.Tokenize(text)), expected) << text;
+            }
+        }
+    }
+}
+
+TEST(TestCaseTokenizer, TestDocumentTermsReuseTokenizer) {
+    // Assign сортирует слова в буфере токенизатора: следующий документ не видит прежний порядок
+    Tokenizer tokenizer;
+    DocumentTerms first;
+    first.Assign("water milk Water tea milk water", tokenizer);
+    ASSERT_EQ(first.terms.size(), 3u);
+    EXPECT_EQ(first.tokenCount, 6u);
+    EXPECT_EQ(first.Word(first.terms[0]), "milk");
+    EXPECT_EQ(first.terms[0].count, 2u);
+    EXPECT_EQ(first.Word(first.terms[2]), "water");
+    EXPECT_EQ(first.terms[2].count, 3u);
+
+    DocumentTerms second;
+    second.Assign("zebra apple " + string(Tokenizer::kMaxWordLength + 1, 'a'), tokenizer);
+    ASSERT_EQ(second.terms.size(), 2u);
+    EXPECT_EQ(second.tokenCount, 3u);
+    EXPECT_EQ(second.Word(second.terms[0]), "apple");
+    EXPECT_EQ(second.Word(second.terms[1]), "zebra");
+    EXPECT_EQ(ToStrings(tokenizer.Tokenize("b a")), (vector<string>{"b", "a"}));
+}
@@ -0,0 +1,46 @@
+#include <string>
+#include <gtest/gtest.h>
+#include "../SEGW/include/Utf8.h"
+
+using namespace std;
+
+TEST(TestCaseUtf8, TestDecode) {
+    const auto decode = [](const string& text, char32_t& codePoint) {
+        return Utf8::Decode(reinterpret_cast<const unsigned char*>(text.data()),
+                            text.size(), codePoint);
+    };
+    char32_t codePoint = 0;
+
+    EXPECT_EQ(decode("a", codePoint), 1u);
+    EXPECT_EQ(codePoint, U'a');
+    EXPECT_EQ(decode("Ж", codePoint), 2u);
+    EXPECT_EQ(codePoint, U'Ж');
+    EXPECT_EQ(decode("€", codePoint), 3u);
+    EXPECT_EQ(codePoint, U'€');
+    EXPECT_EQ(decode("😀", codePoint), 4u);
+    EXPECT_EQ(codePoint, U'😀');
+
+    EXPECT_EQ(decode("\xd0", codePoint), 0u);          // обрыв
+    EXPECT_EQ(decode("\xc1\xbf", codePoint), 0u);      // избыточная кодировка
+    EXPECT_EQ(decode("\xe0\x9f\xbf", codePoint), 0u);  // избыточная кодировка
+    EXPECT_EQ(decode("\xed\xa0\x80", codePoint), 0u);  // суррогат
+    EXPECT_EQ(decode("\xf4\x90\x80\x80", codePoint), 0u);  // больше U+10FFFF
+}
+
+TEST(TestCaseUtf8, TestValidateAndFold) {
+    EXPECT_TRUE(Utf8::IsValid("plain ascii text, long enough for chunks"));
+    EXPECT_TRUE(Utf8::IsValid("Съешь же ещё этих мягких французских булок"));
+    EXPECT_FALSE(Utf8::IsValid("ascii prefix of sixteen \xd0"));
+    EXPECT_FALSE(Utf8::IsValid("\x80"));
+
+    EXPECT_EQ(Utf8::FoldLetter(U'Я'), U'я');
+    EXPECT_EQ(Utf8::FoldLetter(U'Ё'), U'ё');
+    EXPECT_EQ(Utf8::FoldLetter(U'Ѣ'), U'ѣ');
+    EXPECT_EQ(Utf8::FoldLetter(U'Ӏ'), U'ӏ');
+    EXPECT_EQ(Utf8::FoldLetter(U'Ӂ'), U'ӂ');
+    EXPECT_EQ(Utf8::FoldLetter(U'Ä'), U'ä');
+    EXPECT_EQ(Utf8::FoldLetter(U'ß'), U'ß');
+    EXPECT_EQ(Utf8::FoldLetter(U'×'), 0u);
+    EXPECT_EQ(Utf8::FoldLetter(U'№'), 0u);
+    EXPECT_EQ(Utf8::FoldLetter(U'҂'), 0u);
+}